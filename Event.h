@@ -3,8 +3,10 @@
 
 #include <inttypes.h>
 #include <RTL_Variant.h>
+#include "EventFrameworkConfig.h"
 
 
+/// Listeners with many cases can use a handler table instead (see EventHandlerTable.h)
 #define WithEvent(pEvent) EVENT_ID _eventID_ = pEvent->EventID; if (false) {} // Dummy if statement that is always false to make WithEvent/When more syntactically symmetrical
 #define When(eventID) else if (_eventID_ == eventID)
 
@@ -13,6 +15,7 @@ typedef uint16_t EVENT_ID;
 
 
 class EventSource;
+class EventPayload;
 
 
 struct Event            // size = 8?
@@ -40,8 +43,19 @@ struct Event            // size = 8?
 
     Event(EVENT_ID eventID, variant_union_t data) : EventID(eventID) { Data = data; };
 
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    Event(EVENT_ID eventID, EventPayload* pPayload) : EventID(eventID), HasPayload(pPayload != NULL) { Data.Pointer = pPayload; };
+#endif
+
     // Copy constructor
-    Event(const Event& rhs) : EventID(rhs.EventID), Source(rhs.Source), Data(rhs.Data) {  };
+    Event(const Event& rhs) : EventID(rhs.EventID), Data(rhs.Data), Source(rhs.Source)
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        , HasPayload(rhs.HasPayload)
+#endif
+#if EVENT_STATISTICS >= 2
+        , QueuedAt(rhs.QueuedAt)
+#endif
+    {  };
 
     /**************************************************************************
     Operators
@@ -56,6 +70,14 @@ struct Event            // size = 8?
     variant_union_t Data;       // size = 4?
 
     EventSource* Source;        // size = 2
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    bool HasPayload = false;    // size = 1, Data.Pointer points to a pooled EventPayload
+#endif
+
+#if EVENT_STATISTICS >= 2
+    uint32_t QueuedAt;          // size = 4, the value of micros() when the event was queued
+#endif
 };
 
 #endif
@@ -0,0 +1,161 @@
+#ifndef _EventAtomic_h_
+#define _EventAtomic_h_
+
+#include <Arduino.h>
+
+#if EVENTFRAMEWORK_HOST
+#include <atomic>
+#elif defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+
+/*******************************************************************************
+A small atomic value used by the lock-free parts of the framework.
+
+The implementation depends on the platform:
+
+- On the host it is a thin wrapper around std::atomic.
+
+- On AVR, single-byte loads and stores are naturally atomic, so they compile to
+  plain memory accesses. AVR has no compare-and-swap instruction, so wider values,
+  CompareExchange() and FetchAdd() use a (very short) ATOMIC_RESTORESTATE block. The block
+  restores the previous interrupt state rather than blindly re-enabling interrupts,
+  so it is safe to use inside an ISR.
+
+- On ARMv6-M (Cortex-M0/M0+), which also lacks exclusive load/store instructions,
+  CompareExchange() and FetchAdd() mask interrupts via PRIMASK for the duration of
+  the update.
+
+- Everywhere else (e.g., Cortex-M3/M4, ESP32) the GCC __atomic builtins are used,
+  which compile to the native lock-free instructions.
+
+Loads have acquire semantics and stores have release semantics unless the Relaxed
+variant is used.
+*******************************************************************************/
+template<typename T>
+class AtomicValue
+{
+#if EVENTFRAMEWORK_HOST
+
+    public: AtomicValue(T value=0) : _value(value) {};
+
+    public: T    Load() const            { return _value.load(std::memory_order_acquire); };
+    public: T    LoadRelaxed() const     { return _value.load(std::memory_order_relaxed); };
+    public: void Store(T value)          { _value.store(value, std::memory_order_release); };
+    public: void StoreRelaxed(T value)   { _value.store(value, std::memory_order_relaxed); };
+
+    public: bool CompareExchange(T& expected, T desired)
+    {
+        return _value.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_relaxed);
+    };
+
+    public: T FetchAdd(T value) { return _value.fetch_add(value, std::memory_order_relaxed); };
+
+    private: std::atomic<T> _value;
+
+#elif defined(__AVR__)
+
+    public: AtomicValue(T value=0) : _value(value) {};
+
+    public: T Load() const
+    {
+        T value;
+
+        if (sizeof(T) == 1) { value = _value; }
+        else ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { value = _value; }
+
+        __asm__ __volatile__("" ::: "memory");
+        return value;
+    };
+
+    public: T LoadRelaxed() const { return Load(); };
+
+    public: void Store(T value)
+    {
+        __asm__ __volatile__("" ::: "memory");
+
+        if (sizeof(T) == 1) { _value = value; }
+        else ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { _value = value; }
+    };
+
+    public: void StoreRelaxed(T value) { Store(value); };
+
+    public: bool CompareExchange(T& expected, T desired)
+    {
+        bool isExchanged = false;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            if (_value == expected) { _value = desired; isExchanged = true; }
+            else expected = _value;
+        }
+
+        return isExchanged;
+    };
+
+    public: T FetchAdd(T value)
+    {
+        T previous;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { previous = _value; _value = previous + value; }
+
+        return previous;
+    };
+
+    private: volatile T _value;
+
+#else
+
+    public: AtomicValue(T value=0) : _value(value) {};
+
+    public: T    Load() const            { return __atomic_load_n(&_value, __ATOMIC_ACQUIRE); };
+    public: T    LoadRelaxed() const     { return __atomic_load_n(&_value, __ATOMIC_RELAXED); };
+    public: void Store(T value)          { __atomic_store_n(&_value, value, __ATOMIC_RELEASE); };
+    public: void StoreRelaxed(T value)   { __atomic_store_n(&_value, value, __ATOMIC_RELAXED); };
+
+#if defined(__ARM_ARCH_6M__)
+    public: T FetchAdd(T value)
+    {
+        uint32_t primask;
+        T previous;
+
+        __asm__ __volatile__("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+
+        previous = _value;
+        _value = previous + value;
+
+        __asm__ __volatile__("msr primask, %0" :: "r" (primask) : "memory");
+
+        return previous;
+    };
+
+    public: bool CompareExchange(T& expected, T desired)
+    {
+        uint32_t primask;
+        bool isExchanged = false;
+
+        __asm__ __volatile__("mrs %0, primask\n cpsid i" : "=r" (primask) :: "memory");
+
+        if (_value == expected) { _value = desired; isExchanged = true; }
+        else expected = _value;
+
+        __asm__ __volatile__("msr primask, %0" :: "r" (primask) : "memory");
+
+        return isExchanged;
+    };
+#else
+    public: T FetchAdd(T value) { return __atomic_fetch_add(&_value, value, __ATOMIC_RELAXED); };
+
+    public: bool CompareExchange(T& expected, T desired)
+    {
+        return __atomic_compare_exchange_n(&_value, &expected, desired, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+    };
+#endif
+
+    private: volatile T _value;
+
+#endif
+};
+
+#endif
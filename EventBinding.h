@@ -5,6 +5,23 @@
 #include "IEventListener.h"
 
 
+/*******************************************************************************
+Identifies the concrete type of an IEventBinding, so that the framework can tell
+the bindings it knows about apart without relying on RTTI.
+*******************************************************************************/
+class BindingType
+{
+    public: enum
+    {
+        Custom   = 0,   // A user-defined binding class
+        Listener = 1,   // EventBinding
+        Function = 2,   // StaticEventBinding
+        Batch    = 3,   // BatchEventBinding
+        Member   = 4,   // MemberBinding
+    };
+};
+
+
 /*******************************************************************************
 Defines a binding between an EventSource and an EventListener.
 
@@ -17,10 +34,11 @@ to the binding's DispatchEvent() method where the binding forwards the event to
 the associated event listener.
 
 Multiple bindings can be bound to the same EventSource. The bindings are chained
-together as a linked list through the _nextLink member. The AddBinding() and
-RemoveBinding() methods of the EventSource class manage this linked list. To allow
-them to do that, IEventBinding declares EventSource as a friend class so it can
-access the private _nextLink member.
+together as a doubly-linked list through the _nextLink and _prevLink members. The 
+Attach() and Detach() methods of the EventSource class manage this linked list. 
+To allow them to do that, IEventBinding declares EventSource as a friend class so
+it can access the private link members. Each binding also remembers the source it
+is attached to, so attaching, detaching and detecting a duplicate attach are all O(1).
 
 Event bindings are needed to handle the many-to-many relationship between EventSources
 and event listeners. Without bindings, multiple listeners attached to the same
@@ -28,29 +46,78 @@ source could get their event notification chains cross-linked. Since a binding
 can only be bound to one event listener and one EventSource at a time, they ensure
 that there is always a unique event notification chain for each event source.
 
+A binding can subscribe to a subset of a source's events - a single event ID or
+a set of event IDs selected with a mask (see EventMask). The source only dispatches
+matching events to the binding, so the listener doesn't have to filter them.
+
 A class that implements this interface must provide an implementation for the
 DispatchEvent() method to handle events dispatched to it.
 *******************************************************************************/
 class IEventBinding
 {
     friend class EventSource;
+    friend class EventLoop;
 
-    protected: IEventBinding() : _nextLink(NULL) { };
+    protected: IEventBinding(uint8_t type=BindingType::Custom) 
+        : _nextLink(NULL), _prevLink(NULL), _source(NULL), _eventID(0), _eventMask(EventMask::Any), _type(type) { };
 
     public: void BindTo(EventSource& source) 
     { 
         source.Attach(*this); 
     };
 
-    protected: void Unlink(IEventBinding*& prevLink) 
+    public: void BindTo(EventSource& source, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact) 
+    { 
+        source.Subscribe(*this, eventID, eventMask); 
+    };
+
+    /// The source the binding is attached to (NULL if it is not attached)
+    public: EventSource* Source() const { return _source; };
+
+    /// Determines if the binding is subscribed to an event ID
+    public: bool Accepts(EVENT_ID eventID) const { return ((eventID ^ _eventID) & _eventMask) == 0; };
+
+    /// Removes the binding from the binding chain it is in
+    protected: void Unlink() 
     {
-        prevLink == _nextLink;
+        if (_prevLink == NULL) return;
+
+        *_prevLink = _nextLink;
+
+        if (_nextLink != NULL) _nextLink->_prevLink = _prevLink;
+
         _nextLink = NULL;
+        _prevLink = NULL;
+        _source = NULL;
     }
 
     protected: virtual void DispatchEvent(Event& event) = 0;
 
+    /// Dispatches the events in a span that the binding accepts. Bindings that can
+    /// handle a span of events at once override this method.
+    protected: virtual void DispatchEvents(Event* pEvents, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) 
+        {
+            if (Accepts(pEvents[i].EventID)) DispatchEvent(pEvents[i]);
+        }
+    };
+
     protected: IEventBinding* _nextLink;
+
+    /// The pointer that points to this binding (the head of the chain or the
+    /// previous binding's _nextLink), which makes unlinking O(1)
+    private: IEventBinding** _prevLink;
+
+    /// The source the binding is attached to
+    private: EventSource* _source;
+
+    /// The event ID(s) the binding is subscribed to
+    private: EVENT_ID _eventID;
+    private: EVENT_ID _eventMask;
+
+    /// The kind of binding (see BindingType)
+    private: uint8_t _type;
 };
 
 
@@ -61,8 +128,8 @@ class EventBinding : public IEventBinding
 {
     friend class EventSource;
 
-    public: EventBinding() : _pListener(NULL) { };
-    public: EventBinding(IEventListener& listener) : _pListener(&listener) { };
+    public: EventBinding() : IEventBinding(BindingType::Listener), _pListener(NULL) { };
+    public: EventBinding(IEventListener& listener) : IEventBinding(BindingType::Listener), _pListener(&listener) { };
 
     public: void Bind(IEventListener& listener, EventSource& source) 
     { 
@@ -88,8 +155,8 @@ class StaticEventBinding : public IEventBinding
 {
     friend class EventSource;
 
-    public: StaticEventBinding() : _pfEventListener(NULL) { };
-    public: StaticEventBinding(EVENT_LISTENER pfEventListener) : _pfEventListener(pfEventListener) { };
+    public: StaticEventBinding() : IEventBinding(BindingType::Function), _pfEventListener(NULL) { };
+    public: StaticEventBinding(EVENT_LISTENER pfEventListener) : IEventBinding(BindingType::Function), _pfEventListener(pfEventListener) { };
 
     public: void Bind(EVENT_LISTENER pfEventListener, EventSource& source) 
     { 
@@ -105,4 +172,84 @@ class StaticEventBinding : public IEventBinding
     private: EVENT_LISTENER _pfEventListener;
 };
 
+
+
+/*******************************************************************************
+Provides a binding to a specific member function of an object, selected at compile
+time. For example:
+
+    class Robot
+    {
+        public: void OnDetect(const Event* pEvent) { ... };
+        public: void OnBump(const Event* pEvent) { ... };
+    };
+
+    MemberBinding<Robot, &Robot::OnDetect> detectBinding(robot);
+    MemberBinding<Robot, &Robot::OnBump> bumpBinding(robot);
+
+    sonar.Attach(detectBinding);
+    bumper.Attach(bumpBinding);
+
+The object does not have to implement IEventListener, and since the method is a
+template argument the call is direct and can be inlined into the binding; there
+is no listener pointer to check and no second virtual call. A class can handle 
+the events of several sources in separate methods instead of an OnEvent() method
+with a WithEvent/When chain.
+*******************************************************************************/
+template<typename T, void (T::*METHOD)(const Event*)>
+class MemberBinding : public IEventBinding
+{
+    public: MemberBinding(T& object) : IEventBinding(BindingType::Member), _pObject(&object) { };
+
+    protected: virtual void DispatchEvent(Event& event)
+    {
+        (_pObject->*METHOD)(&event);
+    };
+
+    private: T* _pObject;
+};
+
+
+/*******************************************************************************
+Defines a binding between an IBatchEventListener and an EventSource.
+
+The binding passes the listener each run of consecutive events that it accepts 
+as a single span, without copying them.
+*******************************************************************************/
+class BatchEventBinding : public IEventBinding
+{
+    friend class EventSource;
+
+    public: BatchEventBinding() : IEventBinding(BindingType::Batch), _pListener(NULL) { };
+    public: BatchEventBinding(IBatchEventListener& listener) : IEventBinding(BindingType::Batch), _pListener(&listener) { };
+
+    public: void Bind(IBatchEventListener& listener, EventSource& source) 
+    { 
+        _pListener = &listener;
+        source.Attach(*this); 
+    };
+
+    protected: void DispatchEvent(Event& event)
+    {
+        if (_pListener != NULL) _pListener->OnEvents(&event, 1);
+    };
+
+    protected: void DispatchEvents(Event* pEvents, size_t count)
+    {
+        if (_pListener == NULL) return;
+
+        for (size_t first = 0, last; first < count; first = last)
+        {
+            // Find the next run of accepted events
+            while (first < count && !Accepts(pEvents[first].EventID)) first++;
+
+            for (last = first; last < count && Accepts(pEvents[last].EventID); last++) { }
+
+            if (last > first) _pListener->OnEvents(pEvents + first, last - first);
+        }
+    };
+
+    private: IBatchEventListener* _pListener;
+};
+
 #endif
@@ -0,0 +1,90 @@
+/*******************************************************************************
+Captures the stream of events dispatched by event sources. See EventCapture.h
+for details.
+*******************************************************************************/
+#include <Arduino.h>
+#include "EventCapture.h"
+#include "EventSource.h"
+
+#if EVENT_CAPTURE
+
+static_assert(EVENT_CAPTURE_SOURCES < 255, "EVENT_CAPTURE_SOURCES must be less than 255");
+
+
+static const uint8_t UnknownSource = 0xFF;
+static const uint8_t SourceRecord = 1;
+static const uint8_t EventRecord = 2;
+
+
+TRACE_WRITER EventCapture::_writer = NULL;
+EventSource* EventCapture::_sources[EVENT_CAPTURE_SOURCES];
+uint8_t EventCapture::_sourceCount = 0;
+
+
+//******************************************************************************
+// Starts a capture
+//******************************************************************************
+void EventCapture::Start(TRACE_WRITER writer)
+{
+    static const uint8_t header[8] = { 'E', 'V', 'C', 'P', 1, 0, 0, 0 };
+
+    _sourceCount = 0;
+    writer(header, sizeof(header));
+    _writer = writer;
+}
+
+
+//******************************************************************************
+// Records an event dispatched by a source
+//******************************************************************************
+void EventCapture::Record(EventSource* pSource, const Event& event)
+{
+    uint32_t time = micros();
+    uint32_t data = event.Data.UnsignedLong;
+    uint8_t buffer[12];
+
+    buffer[0]  = EventRecord;
+    buffer[1]  = _SourceIndex(pSource);
+    buffer[2]  = (uint8_t)time;
+    buffer[3]  = (uint8_t)(time >> 8);
+    buffer[4]  = (uint8_t)(time >> 16);
+    buffer[5]  = (uint8_t)(time >> 24);
+    buffer[6]  = (uint8_t)event.EventID;
+    buffer[7]  = (uint8_t)(event.EventID >> 8);
+    buffer[8]  = (uint8_t)data;
+    buffer[9]  = (uint8_t)(data >> 8);
+    buffer[10] = (uint8_t)(data >> 16);
+    buffer[11] = (uint8_t)(data >> 24);
+
+    _writer(buffer, sizeof(buffer));
+}
+
+
+//******************************************************************************
+// Returns the capture index of a source. The first time a source is seen its
+// ID is written to the capture.
+//******************************************************************************
+uint8_t EventCapture::_SourceIndex(EventSource* pSource)
+{
+    for (uint8_t i = 0; i < _sourceCount; i++)
+    {
+        if (_sources[i] == pSource) return i;
+    }
+
+    if (_sourceCount == EVENT_CAPTURE_SOURCES) return UnknownSource;
+
+    const char* id = (pSource->ID() != NULL) ? pSource->ID() : "";
+    size_t length = strlen(id);
+
+    if (length > 255) length = 255;
+
+    uint8_t header[3] = { SourceRecord, _sourceCount, (uint8_t)length };
+
+    _writer(header, sizeof(header));
+    _writer((const uint8_t*)id, (uint16_t)length);
+    _sources[_sourceCount] = pSource;
+
+    return _sourceCount++;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _EventCapture_h_
+#define _EventCapture_h_
+
+#include <Arduino.h>
+#include "EventFrameworkConfig.h"
+#include "Event.h"
+#include "EventTrace.h"
+
+
+class EventSource;
+
+
+#if EVENT_CAPTURE
+
+#define EVENT_CAPTURE_EVENT(source, event) if (EventCapture::IsCapturing()) EventCapture::Record((source), (event))
+
+/*******************************************************************************
+Captures the stream of events dispatched by event sources.
+
+While a capture is running, every event that reaches EventSource::DispatchEvent()
+is written out through the capture's writer (e.g., to Serial or an SD card file)
+together with the time it was dispatched. The capture can then be replayed into
+the same listener graph on the host with EventReplay (see host/EventReplay.h) to
+benchmark and regression-test event listeners against a real workload.
+
+Sources are identified by their ID(). The first time a source dispatches an event
+its ID is written to the capture and the source is assigned a small index that
+the event records refer to. Up to EVENT_CAPTURE_SOURCES sources can be told apart;
+the events of any further sources are recorded as coming from an unknown source.
+
+The capture format is a little-endian byte stream:
+
+    Header (8 bytes):  'E' 'V' 'C' 'P', version (1), 3 reserved bytes
+    Source record:     1, source index (1), ID length (1), ID (ID length bytes)
+    Event record:      2, source index (1), time (4), event ID (2), data (4)
+
+Only the 32-bit value of the event data is captured, so events whose data is a
+pointer can't be replayed meaningfully.
+*******************************************************************************/
+class EventCapture
+{
+    /// Starts a capture that writes its data through the given writer
+    public: static void Start(TRACE_WRITER writer);
+
+    /// Stops the capture
+    public: static void Stop() { _writer = NULL; };
+
+    /// Determines if a capture is running
+    public: static bool IsCapturing() { return _writer != NULL; };
+
+    /// Records an event dispatched by a source
+    public: static void Record(EventSource* pSource, const Event& event);
+
+    /// Returns the capture index of a source, writing a source record the first time
+    private: static uint8_t _SourceIndex(EventSource* pSource);
+
+    /// The function that receives the capture data
+    private: static TRACE_WRITER _writer;
+
+    /// The sources that have been written to the capture
+    private: static EventSource* _sources[EVENT_CAPTURE_SOURCES];
+    private: static uint8_t _sourceCount;
+};
+
+#else
+
+#define EVENT_CAPTURE_EVENT(source, event)
+
+#endif
+
+#endif
@@ -55,6 +55,39 @@ class EventCode
 };
 
 
+/*******************************************************************************
+Masks used to subscribe to a set of event IDs (see EventSource::Subscribe()). An
+event matches a subscription when the bits selected by the mask are equal to 
+those of the subscribed event ID.
+*******************************************************************************/
+class EventMask
+{
+    public: enum
+    {
+        Any       = 0x0000,     // Matches every event
+        SourceID  = 0xFF00,     // Matches every event with the same EventSourceID
+        EventCode = 0x00FF,     // Matches every event with the same EventCode
+        Exact     = 0xFFFF,     // Matches only the event ID itself
+    };
+};
+
+
+/*******************************************************************************
+Event priorities. Priority 0 is the highest priority; the number of priorities
+(i.e., priority lanes) is set by EVENT_PRIORITY_LANES. Events queued with the
+Default priority get the priority assigned to their EventCode in their event loop
+(see EventLoop::SetEventPriority()), or EVENT_DEFAULT_PRIORITY if there is none.
+*******************************************************************************/
+class EventPriority
+{
+    public: enum
+    {
+        Highest = 0x00,     // The highest priority lane
+        Default = 0xFF,     // Use the priority assigned to the event's EventCode
+    };
+};
+
+
 enum CommonEvents_enum
 {
     TimerFiredEvent   = EventSourceID::Timer      | EventCode::DefaultEvent,
@@ -2,8 +2,10 @@
 #define _EventDispatcher_h_
 
 #include <RTL_StdLib.h>
+#include "EventFrameworkConfig.h"
 #include "IPollable.h"
 #include "Event.h"
+#include "EventLoop.h"
 
 
 /*******************************************************************************
@@ -11,18 +13,22 @@ Global scheduler and event dispatcher.
 
 EventDispatcher is a global static singleton that polls objects and dispatches 
 events in a program. Objects that implement IPollable register with the EventDispatcher
-and then the EventDispatcher periodically invokes the Poll() method of each one. 
+and then the EventDispatcher periodically invokes the Poll() method of each one,
+either round-robin or when the object's scheduled poll time comes around. 
 The DispatchEvents() method must be invoked in the sketch's loop() method.
 
 Even though EventSources are the most common kind of objects polled by the EventDispatcher,
 other kinds of objects can also be polled as long as they implement the IPollable 
 interface and register with the EventDispatcher.
+
+The EventDispatcher is a static front for the default EventLoop (see EventLoop.h),
+which every IPollable belongs to unless it is added to another EventLoop. The 
+methods that take an object act on the loop the object belongs to.
 *******************************************************************************/
-class EventDispatcher       // size = 71 bytes
+class EventDispatcher
 {
-    DECLARE_CLASSNAME;
-
-    private: static const int QUEUE_SIZE = 8;
+    /// The type of the event queue, as configured in EventFrameworkConfig.h
+    public: typedef EventLoop::EventQueueType EventQueueType;
 
     /***************************************************************************
      Constructors
@@ -34,57 +40,124 @@ class EventDispatcher       // size = 71 bytes
     Public Methods
     ***************************************************************************/
 
+    /// The default event loop
+    public: static EventLoop& Default()
+    {
+        // Constructed on first use, so IPollables created during static initialization
+        // in other translation units always find it
+        static EventLoop loop;
+
+        return loop;
+    };
+
     /// Polls the registered poll-able objects.
     /// This method must be called from the Sketch's loop() method.
-    public: static void DispatchEvents();
+    public: static void DispatchEvents() { Default().DispatchEvents(); };
+
+    /// Keeps polling the registered poll-able objects and dispatching events until
+    /// 'budgetMicros' microseconds have passed, or until a whole round of polling
+    /// finds nothing to do. Returns the number of microseconds used.
+    public: static uint32_t DispatchEvents(uint32_t budgetMicros) { return Default().DispatchEvents(budgetMicros); };
+
+    /// Waits until the default loop has something to do, or until 'timeoutMicros'
+    /// microseconds have passed (see EventLoop::WaitForEvents())
+    public: static bool WaitForEvents(uint32_t timeoutMicros) { return Default().WaitForEvents(timeoutMicros); };
 
-    /// Adds a poll-able object
-    public: static void Add(IPollable& obj);
+    /// Sets the function WaitForEvents() uses to sleep (see EventLoop::SetSleepFunction())
+    public: static void SetSleepFunction(SLEEP_FUNCTION pfSleep) { Default().SetSleepFunction(pfSleep); };
 
-    /// Adds a poll function
-    public: static IPollable* Add(POLL_FUNCTION pfPollFunction);
+    /// Adds a poll-able object to the default loop
+    public: static void Add(IPollable& obj) { Default().Add(obj); };
 
-    /// Removes a poll-able object
-    public: static void Remove(IPollable& obj);
+    /// Adds a poll function to the default loop. The IPollable wrapper for the 
+    /// function comes from a fixed-size pool; returns NULL if the pool is exhausted.
+    public: static IPollable* Add(POLL_FUNCTION pfPollFunction) { return Default().Add(pfPollFunction); };
 
-    public: static bool Queue(Event& event);
+    /// Removes a poll-able object. A wrapper created by Add(POLL_FUNCTION) is 
+    /// returned to its pool.
+    public: static void Remove(IPollable& obj) { obj.GetEventLoop().Remove(obj); };
+
+#if EVENT_SCHEDULED_POLLING
+    /// Polls an object every 'periodMicros' microseconds instead of round-robin.
+    /// A period of 0 returns the object to round-robin polling.
+    public: static void SetPollPeriod(IPollable& obj, uint32_t periodMicros) { obj.GetEventLoop().SetPollPeriod(obj, periodMicros); };
+
+    /// Polls an object once, 'delayMicros' microseconds from now, instead of
+    /// round-robin.
+    public: static void PollAfter(IPollable& obj, uint32_t delayMicros) { obj.GetEventLoop().PollAfter(obj, delayMicros); };
+#endif
+
+    /// Polls an object only after it has been marked ready, instead of round-robin
+    public: static void PollWhenReady(IPollable& obj) { obj.GetEventLoop().PollWhenReady(obj); };
+
+    /// Marks an object as ready, so it is polled on the next call to DispatchEvents().
+    /// Can be called from an ISR.
+    public: static void SetReady(IPollable& obj) { obj.GetEventLoop().SetReady(obj); };
+
+    /// Queues an event to the default loop's event queue with the given priority.
+    /// Returns false if the event could not be queued.
+    public: static bool Queue(Event& event, uint8_t priority=EventPriority::Default) { return Default().Queue(event, priority); };
 
     //public: static bool Queue(EventSource& source, Event& event);
 
-    /// De-queues an event from the event queue.
-    public: static bool Dequeue(Event& event);
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+    /// Queues an event to the default loop once, 'delayMicros' microseconds from now.
+    /// Returns a handle for CancelTimer(), or 0 if the timer pool is exhausted.
+    public: static EVENT_TIMER QueueEventAfter(Event& event, uint32_t delayMicros, uint8_t priority=EventPriority::Default) { return Default().QueueEventAfter(event, delayMicros, priority); };
 
-    /***************************************************************************
-    Internal implementation
-    ***************************************************************************/
-    private: inline static void _Dequeue(Event& event)
-    {
-        noInterrupts(); // ATOMIC BLOCK BEGIN
+    /// Queues an event to the default loop every 'periodMicros' microseconds until
+    /// the timer is cancelled. Returns a handle for CancelTimer(), or 0 if the timer
+    /// pool is exhausted.
+    public: static EVENT_TIMER QueueEventEvery(Event& event, uint32_t periodMicros, uint8_t priority=EventPriority::Default) { return Default().QueueEventEvery(event, periodMicros, priority); };
 
-        event = _queue[_queueHead];
-        _queueHead = (_queueHead + 1) % QUEUE_SIZE;
-        _queueCount--;
+    /// Cancels an event timer. Returns false if the handle is stale.
+    public: static bool CancelTimer(EVENT_TIMER timer) { return EventLoop::CancelTimer(timer); };
+#endif
 
-        interrupts(); // ATOMIC BLOCK END
-    }
-    
-    
-    /***************************************************************************
-    Internal state
-    ***************************************************************************/
-    /// The event queue 
-    private: static Event _queue[QUEUE_SIZE];   // size = sizeof(Event)*QUEUE_SIZE = 8*8 = 64 bytes
+    /// De-queues the highest priority event from the default loop's event queue. The
+    /// caller takes over the event's payload reference (see EventPayload), if it has one.
+    public: static bool Dequeue(Event& event) { return Default().Dequeue(event); };
+
+    /// Assigns the priority used for events with the given EventCode that are 
+    /// queued with the default priority.
+    /// Returns false if the priority map is full.
+    public: static bool SetEventPriority(uint8_t eventCode, uint8_t priority) { return Default().SetEventPriority(eventCode, priority); };
+
+    /// Returns the priority assigned to an event ID's EventCode
+    public: static uint8_t GetEventPriority(EVENT_ID eventID) { return Default().GetEventPriority(eventID); };
 
-    /// The event queue head and tail pointers
-    private: static uint8_t _queueHead;         // size = 1
-    private: static uint8_t _queueTail;         // size = 1
-    private: static int8_t  _queueCount;        // size = 1
+    /// Sets the number of events a lane may dispatch per round when the lanes are
+    /// drained with PriorityScheduling::Weighted
+    public: static void SetLaneWeight(uint8_t priority, uint8_t weight) { Default().SetLaneWeight(priority, weight); };
 
-    /// The first object in the EventDispatcher's polling list (linked list)
-    private: static IPollable* _first;          // size = 2
+#if EVENT_STATISTICS
+    /// Gets a snapshot of the default loop's runtime statistics
+    public: static void GetStatistics(EventStatistics& stats) { Default().GetStatistics(stats); };
 
-    /// The current object being polled
-    private: static IPollable* _current;        // size = 2
+    /// Resets the default loop's runtime statistics
+    public: static void ResetStatistics() { Default().ResetStatistics(); };
+#endif
+
+    /// Turns coalescing on or off for all events with the given event ID.
+    /// Returns false if the coalescing map is full.
+    public: static bool SetCoalescing(EVENT_ID eventID, bool isCoalescing=true) { return Default().SetCoalescing(eventID, isCoalescing); };
+
+#if EVENT_TOPIC_BUCKETS > 0
+    /// Subscribes a binding or listener to the matching events of all of the default
+    /// loop's sources (see EventLoop::Subscribe())
+    public: static void Subscribe(IEventBinding& binding, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact) { Default().Subscribe(binding, eventID, eventMask); };
+    public: static IEventBinding* Subscribe(IEventListener& listener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, EventBinding* pBinding=NULL) { return Default().Subscribe(listener, eventID, eventMask, pBinding); };
+    public: static IEventBinding* Subscribe(EVENT_LISTENER pfListener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, StaticEventBinding* pBinding=NULL) { return Default().Subscribe(pfListener, eventID, eventMask, pBinding); };
+
+    /// Removes a topic subscription of the default loop
+    public: static void Unsubscribe(IEventBinding& binding) { Default().Unsubscribe(binding); };
+#endif
+
+#if EVENTFRAMEWORK_HOST
+    /// Hands the events de-queued by DispatchEvents() to a handler rather than 
+    /// dispatching them to their sources (see EventLoop::SetDispatchHandler())
+    public: static void SetDispatchHandler(DISPATCH_HANDLER handler) { Default().SetDispatchHandler(handler); };
+#endif
 };
 
 #endif
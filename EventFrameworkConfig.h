@@ -0,0 +1,218 @@
+#ifndef _EventFrameworkConfig_h_
+#define _EventFrameworkConfig_h_
+
+/*******************************************************************************
+Compile-time configuration for the event framework.
+
+Each setting can be overridden by defining the macro before this file is included
+(e.g., with a -D compiler flag or in a header that is included first).
+
+Settings that default to 0 are off and cost nothing. The following features are
+on by default; on a small board the RAM they take (AVR sizes) can be saved by
+turning them off:
+
+- EVENT_QUEUE_MODEL is MultiProducer (the framework originally used the Guarded
+  queue, which disables interrupts around every queue operation).
+- EVENT_COALESCE_SLOTS (8): about 82 bytes per EventLoop, and a lookup of the 
+  source and the coalescing map for every queued event.
+- EVENT_SCHEDULED_POLLING (1): 13 bytes per IPollable, about 116 bytes per 
+  EventLoop for the timer wheel and its clock, and 26 bytes per event timer.
+- EVENT_BINDING_BUCKETS (4): 8 bytes per EventSource.
+- EVENT_TOPIC_BUCKETS (8): 18 bytes per EventLoop, and a routing table lookup for
+  every dispatched event.
+- EVENT_STATISTICS (1): 20 bytes per EventLoop, and a few counter updates for 
+  every queued and dispatched event.
+*******************************************************************************/
+
+/// The capacity of the event queue. Must be a power of two.
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 8
+#endif
+
+/// What the event queue does when an event is queued while it is full.
+/// One of the QueueOverflowPolicy values (see EventQueue.h).
+#ifndef EVENT_QUEUE_OVERFLOW_POLICY
+#define EVENT_QUEUE_OVERFLOW_POLICY QueueOverflowPolicy::RejectNewest
+#endif
+
+/// How the event queue is synchronized. One of the EventQueueModel values (see 
+/// EventQueue.h). The lock-free models never disable interrupts on the fast path
+/// but only support QueueOverflowPolicy::RejectNewest; the other overflow policies
+/// require EventQueueModel::Guarded.
+#ifndef EVENT_QUEUE_MODEL
+#define EVENT_QUEUE_MODEL EventQueueModel::MultiProducer
+#endif
+
+/// The number of event priority lanes. Each lane is a separate event queue of
+/// EVENT_QUEUE_SIZE events. Lane 0 has the highest priority.
+#ifndef EVENT_PRIORITY_LANES
+#define EVENT_PRIORITY_LANES 1
+#endif
+
+/// The priority lane used for events whose EventCode has no assigned priority.
+#ifndef EVENT_DEFAULT_PRIORITY
+#define EVENT_DEFAULT_PRIORITY (EVENT_PRIORITY_LANES / 2)
+#endif
+
+/// How DispatchEvents() drains the priority lanes. One of the PriorityScheduling
+/// values (see EventLoop.h).
+#ifndef EVENT_PRIORITY_SCHEDULING
+#define EVENT_PRIORITY_SCHEDULING PriorityScheduling::Strict
+#endif
+
+/// The maximum number of EventCodes that can be assigned a priority with
+/// EventLoop::SetEventPriority(). Each EventLoop has its own priority map.
+#ifndef EVENT_PRIORITY_MAP_SIZE
+#define EVENT_PRIORITY_MAP_SIZE 8
+#endif
+
+/// The number of slots in the coalescing index, i.e., the maximum number of distinct
+/// (Source, EventID) pairs that can have a coalesced event pending at the same time.
+/// Must be a power of two, or 0 to remove event coalescing altogether. Costs 9 
+/// bytes per slot per EventLoop.
+#ifndef EVENT_COALESCE_SLOTS
+#define EVENT_COALESCE_SLOTS 8
+#endif
+
+/// The maximum number of event IDs that can be marked for coalescing with
+/// EventLoop::SetCoalescing(). Each EventLoop has its own coalescing map, at 2 
+/// bytes per entry.
+#ifndef EVENT_COALESCE_MAP_SIZE
+#define EVENT_COALESCE_MAP_SIZE 4
+#endif
+
+/// Enables scheduled polling, which lets an IPollable declare a poll period or the
+/// time of its next poll rather than being polled round-robin. Costs 13 bytes per
+/// IPollable plus the timer wheel; set to 0 to remove it.
+#ifndef EVENT_SCHEDULED_POLLING
+#define EVENT_SCHEDULED_POLLING 1
+#endif
+
+/// The resolution of the timer wheel used for scheduled polling, in microseconds.
+#ifndef EVENT_WHEEL_TICK_MICROS
+#define EVENT_WHEEL_TICK_MICROS 1000
+#endif
+
+/// The number of levels in the timer wheel, and the number of slots per level as
+/// a power of two. The wheel spans 2^(EVENT_WHEEL_LEVELS*EVENT_WHEEL_SLOT_BITS) ticks
+/// without needing to re-place long-running timers.
+#ifndef EVENT_WHEEL_LEVELS
+#define EVENT_WHEEL_LEVELS 3
+#endif
+
+#ifndef EVENT_WHEEL_SLOT_BITS
+#define EVENT_WHEEL_SLOT_BITS 4
+#endif
+
+/// The number of event timers (see EventLoop::QueueEventAfter() and QueueEventEvery())
+/// shared by all event loops, at most 255. Each timer takes about 26 bytes. Event
+/// timers run on the scheduled polling timer wheel, so they also require 
+/// EVENT_SCHEDULED_POLLING.
+#ifndef EVENT_TIMER_POOL_SIZE
+#define EVENT_TIMER_POOL_SIZE 4
+#endif
+
+/// The number of hash buckets each EventSource uses to index the bindings that
+/// subscribe to an exact event ID. Must be a power of two, or 0 to keep all of a
+/// source's bindings in a single list. Costs 2 bytes per bucket per EventSource.
+#ifndef EVENT_BINDING_BUCKETS
+#define EVENT_BINDING_BUCKETS 4
+#endif
+
+/// The number of buckets in each EventLoop's topic routing table, which indexes
+/// the topic subscriptions (see EventLoop::Subscribe()) by EventSourceID. Must be
+/// a power of two, or 0 to turn topic subscriptions off. Costs 2 bytes per bucket
+/// (plus 2) per EventLoop.
+#ifndef EVENT_TOPIC_BUCKETS
+#define EVENT_TOPIC_BUCKETS 8
+#endif
+
+/// The number of EventBindings, StaticEventBindings and PollableDelegates that the
+/// framework can create on behalf of the caller (e.g., in EventSource::Attach(IEventListener&)
+/// or EventLoop::Add(POLL_FUNCTION)). These come from fixed-size pools rather
+/// than the heap; when a pool is exhausted the method that needs it returns NULL.
+/// The pools are shared by all event loops.
+#ifndef EVENT_BINDING_POOL_SIZE
+#define EVENT_BINDING_POOL_SIZE 8
+#endif
+
+#ifndef EVENT_STATIC_BINDING_POOL_SIZE
+#define EVENT_STATIC_BINDING_POOL_SIZE 4
+#endif
+
+#ifndef EVENT_DELEGATE_POOL_SIZE
+#define EVENT_DELEGATE_POOL_SIZE 4
+#endif
+
+/// Runtime statistics (see EventLoop::GetStatistics()), kept by each EventLoop.
+///   0 - Off.
+///   1 - Counters: events dispatched, dropped and coalesced, and the queue's 
+///       high-water mark. Costs 20 bytes per EventLoop.
+///   2 - Counters plus enqueue-to-dispatch latency (maximum and histogram). This
+///       time-stamps every queued event, which adds 4 bytes to each Event.
+#ifndef EVENT_STATISTICS
+#define EVENT_STATISTICS 1
+#endif
+
+/// Per-source statistics (see EventSource::QueuedCount() and EventSource::DroppedCount()).
+/// Adds 4 bytes to each EventSource.
+#ifndef EVENT_SOURCE_STATISTICS
+#define EVENT_SOURCE_STATISTICS 0
+#endif
+
+/// Per-source queue quotas (see EventSource::SetQueueQuota()). Requires the
+/// QueueOverflowPolicy::RejectNewest overflow policy. Adds 3 bytes to each 
+/// EventSource.
+#ifndef EVENT_SOURCE_QUOTAS
+#define EVENT_SOURCE_QUOTAS 0
+#endif
+
+/// The number of buckets in the latency histogram. Bucket 0 counts latencies below
+/// 16us and each following bucket covers twice the range of the one before it;
+/// the last bucket counts everything above that.
+#ifndef EVENT_LATENCY_BUCKETS
+#define EVENT_LATENCY_BUCKETS 12
+#endif
+
+/// The number of records in the binary trace recorder (see EventTrace). Must be
+/// 0 (no tracing) or a power of 2. Each record takes 12 bytes.
+#ifndef EVENT_TRACE_SIZE
+#define EVENT_TRACE_SIZE 0
+#endif
+
+/// Event capture (see EventCapture). Records every event dispatched by an event
+/// source so the stream can be replayed on the host (see host/EventReplay.h).
+#ifndef EVENT_CAPTURE
+#define EVENT_CAPTURE 0
+#endif
+
+/// The number of distinct event sources a capture can identify
+#ifndef EVENT_CAPTURE_SOURCES
+#define EVENT_CAPTURE_SOURCES 16
+#endif
+
+/// The number of blocks in the event payload pool (see EventPayload). 0 disables
+/// pooled payloads.
+#ifndef EVENT_PAYLOAD_POOL_SIZE
+#define EVENT_PAYLOAD_POOL_SIZE 0
+#endif
+
+/// The size of a pooled event payload, in bytes
+#ifndef EVENT_PAYLOAD_SIZE
+#define EVENT_PAYLOAD_SIZE 32
+#endif
+
+/// The number of events DispatchEvents() de-queues at a time and groups by source,
+/// so that batch listeners (see IBatchEventListener) receive a source's events in
+/// one call. 0 dispatches the events one at a time; the maximum is 255. Each 
+/// event in a batch takes sizeof(Event) bytes of stack.
+#ifndef EVENT_BATCH_SIZE
+#define EVENT_BATCH_SIZE 0
+#endif
+
+/// The number of bindings in the pool used by EventSource::Attach(IBatchEventListener&)
+#ifndef EVENT_BATCH_BINDING_POOL_SIZE
+#define EVENT_BATCH_BINDING_POOL_SIZE 2
+#endif
+
+#endif
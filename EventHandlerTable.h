@@ -0,0 +1,130 @@
+#ifndef _EventHandlerTable_h_
+#define _EventHandlerTable_h_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "Event.h"
+
+
+/// Declares a table of event handlers in an event listener's method. The entries
+/// pair an event ID with a method of the listener's class. They are not sorted for
+/// you: they must be written in ascending order of event ID, or the table fails to
+/// compile.
+///
+///     WithEventTable(Robot, pEvent)
+///     {
+///         { TimerFiredEvent,   &Robot::OnTimer },       // 0x0100
+///         { TaskStartedEvent,  &Robot::OnTaskStarted }, // 0x0D10
+///         { TaskAbortedEvent,  &Robot::OnTaskAborted }, // 0x0D12
+///     };
+///     DispatchEventTable;
+#define WithEventTable(T, pEvent) const Event* _pEvent_ = pEvent; static constexpr EventHandler<T> _eventHandlers_[] =
+
+/// Invokes the handler in the table declared by WithEventTable for the event.
+/// Evaluates to false if the table has no handler for the event.
+#define DispatchEventTable (EventHandlerTable::Dispatch<EventHandlerTable::Layout(_eventHandlers_)>(_eventHandlers_, *this, _pEvent_))
+
+
+/// An entry of an event handler table
+template<typename T>
+struct EventHandler
+{
+    EVENT_ID EventID;
+    void (T::*Handler)(const Event*);
+};
+
+
+/*******************************************************************************
+How the entries of an event handler table are laid out, which determines how the
+handler for an event is found.
+*******************************************************************************/
+class EventTableLayout
+{
+    public: enum
+    {
+        Unsorted = 0,   // Not in ascending order of event ID (not allowed)
+        Sorted   = 1,   // In ascending order of event ID; found by a binary search
+        Dense    = 2,   // Consecutive event IDs; found by indexing the table
+    };
+};
+
+
+template<uint8_t LAYOUT> struct _EventTableSearch
+{
+    template<typename T, size_t N>
+    static size_t Find(const EventHandler<T> (&table)[N], EVENT_ID eventID)
+    {
+        size_t low = 0, high = N;
+
+        while (low < high)
+        {
+            size_t middle = (low + high) / 2;
+
+            if (table[middle].EventID < eventID) low = middle + 1;
+            else high = middle;
+        }
+
+        return (low < N && table[low].EventID == eventID) ? low : N;
+    }
+};
+
+template<> struct _EventTableSearch<EventTableLayout::Dense>
+{
+    template<typename T, size_t N>
+    static size_t Find(const EventHandler<T> (&table)[N], EVENT_ID eventID)
+    {
+        // An event ID below the first one wraps around to a large index
+        return (EVENT_ID)(eventID - table[0].EventID);
+    }
+};
+
+
+/*******************************************************************************
+Dispatches events through a table of (event ID, handler) pairs.
+
+A WithEvent/When chain compares the event ID with each case in turn, so a listener
+with many cases pays for all the comparisons before the last one on every event.
+A handler table is checked and laid out at compile time instead: if its event IDs
+are consecutive (e.g., the EventCodes of a single source) the handler is found by
+indexing the table, and otherwise by a binary search. A table that is not in
+ascending order of event ID fails to compile.
+
+The table is normally declared with the WithEventTable and DispatchEventTable
+macros, but it can be any constexpr array of EventHandler entries.
+*******************************************************************************/
+class EventHandlerTable
+{
+    /// Determines how the entries of a table are laid out (see EventTableLayout)
+    public: template<typename T, size_t N>
+    static constexpr uint8_t Layout(const EventHandler<T> (&table)[N])
+    {
+        return !_IsSorted(table, 1) ? EventTableLayout::Unsorted
+            : (size_t)(table[N - 1].EventID - table[0].EventID) == N - 1 ? EventTableLayout::Dense
+            : EventTableLayout::Sorted;
+    }
+
+    /// Invokes the object's handler for an event. Returns false if the table has
+    /// no handler for the event.
+    public: template<uint8_t LAYOUT, typename T, size_t N>
+    static bool Dispatch(const EventHandler<T> (&table)[N], T& object, const Event* pEvent)
+    {
+        static_assert(LAYOUT != EventTableLayout::Unsorted, "The entries of an event handler table must be in ascending order of event ID");
+
+        size_t i = _EventTableSearch<LAYOUT>::Find(table, pEvent->EventID);
+
+        if (i >= N) return false;
+
+        (object.*table[i].Handler)(pEvent);
+
+        return true;
+    }
+
+    /// Determines if the entries of a table from entry 'i' on are in ascending order
+    private: template<typename T, size_t N>
+    static constexpr bool _IsSorted(const EventHandler<T> (&table)[N], size_t i)
+    {
+        return i >= N || (table[i - 1].EventID < table[i].EventID && _IsSorted(table, i + 1));
+    }
+};
+
+#endif
@@ -0,0 +1,1538 @@
+#define DEBUG 0
+
+#include <Arduino.h>
+#include <RTL_Debug.h>
+#include "EventSource.h"
+#include "EventBinding.h"
+#include "EventDispatcher.h"
+
+
+/*******************************************************************************
+Event loop: poller and event dispatcher.
+
+An EventLoop polls objects and dispatches the events queued to it. Objects are
+added to a loop via the Add() methods and then the loop invokes the Poll() method
+of each object. EventDispatcher is a static facade over the default loop,
+EventDispatcher::Default(), which every object belongs to unless it is added to
+another loop.
+
+The EventLoop::DispatchEvents() method should be invoked on every iteration
+of the sketch's loop() method. The DispatchEvent() method only polls one object
+per iteration. That is, it will poll the first object on the first iteration, the
+second object on the second iteration, and so on. When it reaches the end of the
+polling list it will start over. This technique is a compromise that allows each
+iteration of the loop() method to finish as quickly as possible, while still
+ensuring that all objects are polled in a timely fashion.
+
+Objects that have a poll period or due time (see IPollable::SetPollPeriod() and
+IPollable::PollAfter()) are not in the round-robin polling list. Instead they are
+kept in a timer wheel, and each call to DispatchEvents() polls all the objects
+that have come due since the previous call.
+
+Objects that are marked ready with IPollable::SetReady() (e.g., from an ISR) are
+kept in a ready list, and each call to DispatchEvents() polls the objects that 
+were ready when it started. Objects that call IPollable::PollWhenReady() are only
+polled that way, so the cost of polling them is proportional to their activity.
+
+When nothing is polled round-robin, WaitForEvents() lets the sketch sleep between
+calls to DispatchEvents(): it works out when the next scheduled poll is due and
+sleeps until then, or until an interrupt queues an event or marks an object ready.
+
+Topic subscriptions are bindings that are linked into the loop's routing table
+rather than into a source's binding lists. EventSource::DispatchEvent() consults
+the routing table of the source's loop after the source's own bindings.
+*******************************************************************************/
+
+DEFINE_CLASSNAME(EventLoop);
+
+#if EVENT_COALESCE_SLOTS > 0
+static_assert((EVENT_COALESCE_SLOTS & (EVENT_COALESCE_SLOTS - 1)) == 0, "EVENT_COALESCE_SLOTS must be a power of two");
+
+// The states of a coalescing slot that isn't claimed (see EventLoop::_QueueCoalesced())
+static const uint8_t SLOT_FREE    = 0;
+static const uint8_t SLOT_PENDING = 1;
+#endif
+
+ObjectPool<PollableDelegate, EVENT_DELEGATE_POOL_SIZE> EventLoop::_delegatePool;
+
+#if EVENT_BATCH_SIZE > 0
+static_assert(EVENT_BATCH_SIZE <= 255, "EVENT_BATCH_SIZE must be at most 255");
+#endif
+
+#if EVENT_SOURCE_QUOTAS
+static_assert(EVENT_QUEUE_OVERFLOW_POLICY == QueueOverflowPolicy::RejectNewest, "EVENT_SOURCE_QUOTAS requires QueueOverflowPolicy::RejectNewest");
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+static_assert((EVENT_TOPIC_BUCKETS & (EVENT_TOPIC_BUCKETS - 1)) == 0, "EVENT_TOPIC_BUCKETS must be a power of two");
+#endif
+
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+static_assert(EVENT_TIMER_POOL_SIZE <= 255, "EVENT_TIMER_POOL_SIZE must be at most 255");
+
+ObjectPool<EventTimer, EVENT_TIMER_POOL_SIZE> EventLoop::_timerPool;
+uint8_t EventLoop::_timerSerial[EVENT_TIMER_POOL_SIZE];
+#endif
+
+
+EventLoop::EventLoop()
+{
+    _first = nullptr;
+    _last = nullptr;
+    _current = nullptr;
+    _currentPolls = 0;
+
+    _firstReady = nullptr;
+    _lastReady = nullptr;
+    _readyCount = 0;
+
+#if EVENTFRAMEWORK_HOST
+    _dispatchHandler = nullptr;
+    _sleepFunction = HostPlatform::Sleep;
+#else
+    _sleepFunction = nullptr;
+#endif
+
+#if EVENT_STATISTICS
+    ResetStatistics();
+#endif
+
+#if EVENT_SCHEDULED_POLLING
+    _wheelTicks = 0;
+    _wheelMicros = 0;
+    _wheelRemainder = 0;
+
+#if EVENT_TIMER_POOL_SIZE > 0
+    _cancelledTimers.Store(nullptr);
+#endif
+#endif
+
+    memset(_laneWeight, 0, sizeof(_laneWeight));
+    _priorityMapCount = 0;
+
+#if EVENT_COALESCE_SLOTS > 0
+    for (uint8_t i = 0; i < EVENT_COALESCE_SLOTS; i++) _coalesce[i].State = SLOT_FREE;
+
+    _coalesceClaim = SLOT_PENDING;
+    _coalesceMapCount = 0;
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+    for (uint8_t i = 0; i < EVENT_TOPIC_BUCKETS; i++) _topic[i] = nullptr;
+
+    _anyTopic = nullptr;
+#endif
+}
+
+
+//******************************************************************************
+// Add a poll-able object the polling list
+//******************************************************************************
+void EventLoop::Add(IPollable& obj)
+{
+    _Adopt(obj);
+
+    // Adding an object that is already in the polling list does nothing
+    if (obj._isRoundRobin) return;
+
+#if EVENT_SCHEDULED_POLLING
+    // Adding an object that is scheduled returns it to round-robin polling
+    _wheel.Cancel(obj);
+    obj._pollPeriod = 0;
+#endif
+
+    // The object is always added at the end of the list
+    obj._isRoundRobin = true;
+    obj._nextObject = nullptr;
+    obj._prevObject = _last;
+
+    if (_last != nullptr)
+    {
+        _last->_nextObject = &obj;
+    }
+    else
+    {
+        // The list was empty
+        _first = &obj;
+        _current = _first;
+        _currentPolls = 0;
+    }
+
+    _last = &obj;
+}
+
+
+//******************************************************************************
+// Add a poll-able function to the polling list
+//******************************************************************************
+IPollable* EventLoop::Add(POLL_FUNCTION pfPollFunction)
+{
+    IPollable* pollObj = _delegatePool.Allocate(pfPollFunction);
+
+    if (pollObj == nullptr) return nullptr;
+
+    Add(*pollObj);
+
+    return pollObj;
+}
+
+
+//******************************************************************************
+// Removes an object from the polling list
+//******************************************************************************
+void EventLoop::Remove(IPollable& obj)
+{
+    obj._loop->_Detach(obj);
+
+    // Return poll function wrappers created by Add() to their pool
+    if (_delegatePool.Owns(&obj)) _delegatePool.Free(static_cast<PollableDelegate*>(&obj));
+}
+
+
+//******************************************************************************
+// Makes an object that belongs to another loop belong to this one
+//******************************************************************************
+void EventLoop::_Adopt(IPollable& obj)
+{
+    if (obj._loop == this) return;
+
+    obj._loop->_Detach(obj);
+    obj._loop = this;
+}
+
+
+//******************************************************************************
+// Takes an object out of the polling list, the timer wheel and the ready list
+//******************************************************************************
+void EventLoop::_Detach(IPollable& obj)
+{
+    _Unregister(obj);
+
+    // Take the object out of the ready list. Removing objects is rare, so a linear
+    // search of the (typically short) list is fine.
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    if (obj._isReady)
+    {
+        IPollable* pPrev = nullptr;
+
+        for (IPollable* p = _firstReady; p != &obj; p = p->_nextReady) pPrev = p;
+
+        if (pPrev != nullptr) pPrev->_nextReady = obj._nextReady;
+        else _firstReady = obj._nextReady;
+
+        if (_lastReady == &obj) _lastReady = pPrev;
+
+        obj._nextReady = nullptr;
+        obj._isReady = false;
+        _readyCount--;
+    }
+
+    interrupts(); // ATOMIC BLOCK END
+}
+
+
+//******************************************************************************
+// Takes an object out of the polling list and the timer wheel
+//******************************************************************************
+void EventLoop::_Unregister(IPollable& obj)
+{
+#if EVENT_SCHEDULED_POLLING
+    _wheel.Cancel(obj);
+    obj._pollPeriod = 0;
+#endif
+
+    if (!obj._isRoundRobin) return;
+
+    TRACE(Logger(_classname_) << F("Remove: object=") << _HEX(PTR(&obj)) << endl);
+
+    IPollable* pNext = obj._nextObject;
+    IPollable* pPrev = obj._prevObject;
+
+    if (pPrev != nullptr) pPrev->_nextObject = pNext;
+    else _first = pNext;
+
+    if (pNext != nullptr) pNext->_prevObject = pPrev;
+    else _last = pPrev;
+
+    // Adjust the _current pointer if we are removing the current object
+    if (_current == &obj)
+    {
+        _current = (pNext != nullptr) ? pNext : _first;
+        _currentPolls = 0;
+    }
+
+    // Make sure the object's links are empty to prevent future issues
+    obj._isRoundRobin = false;
+    obj._nextObject = nullptr;
+    obj._prevObject = nullptr;
+}
+
+
+//******************************************************************************
+// Polls an object only after it has been marked ready
+//******************************************************************************
+void EventLoop::PollWhenReady(IPollable& obj)
+{
+    _Adopt(obj);
+    _Unregister(obj);
+}
+
+
+//******************************************************************************
+// Marks an object as ready to be polled
+//******************************************************************************
+void EventLoop::SetReady(IPollable& obj)
+{
+    // The object is polled by the loop it belongs to
+    if (obj._loop != this)
+    {
+        obj._loop->SetReady(obj);
+        return;
+    }
+
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    if (!obj._isReady)
+    {
+        obj._isReady = true;
+        obj._nextReady = nullptr;
+
+        if (_lastReady != nullptr) _lastReady->_nextReady = &obj;
+        else _firstReady = &obj;
+
+        _lastReady = &obj;
+        _readyCount++;
+    }
+
+    interrupts(); // ATOMIC BLOCK END
+
+#if EVENTFRAMEWORK_HOST
+    HostPlatform::Wake();
+#endif
+}
+
+
+//******************************************************************************
+// Polls the objects that were ready when the method was called. Objects that are
+// marked ready again while they are polled are polled on the next call.
+//******************************************************************************
+void EventLoop::_PollReady()
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+    uint16_t count = _readyCount;
+    interrupts(); // ATOMIC BLOCK END
+
+    for ( ; count > 0; count--)
+    {
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+
+        IPollable* pObj = _firstReady;
+
+        if (pObj != nullptr)
+        {
+            _firstReady = pObj->_nextReady;
+
+            if (_firstReady == nullptr) _lastReady = nullptr;
+
+            pObj->_nextReady = nullptr;
+            pObj->_isReady = false;
+            _readyCount--;
+        }
+
+        interrupts(); // ATOMIC BLOCK END
+
+        if (pObj == nullptr) break;
+
+        EVENT_TRACE(EventTraceType::PollStart, pObj, 0, 0);
+        pObj->Poll();
+        EVENT_TRACE(EventTraceType::PollEnd, pObj, 0, 0);
+    }
+}
+
+
+#if EVENT_SCHEDULED_POLLING
+//******************************************************************************
+// Polls an object periodically
+//******************************************************************************
+void EventLoop::SetPollPeriod(IPollable& obj, uint32_t periodMicros)
+{
+    if (periodMicros == 0)
+    {
+        Add(obj);
+        return;
+    }
+
+    _Adopt(obj);
+    _Unregister(obj);
+
+    obj._pollPeriod = _ToTicks(periodMicros);
+    _wheel.Schedule(obj, _UpdateWheelClock() + obj._pollPeriod);
+}
+
+
+//******************************************************************************
+// Polls an object once after a delay
+//******************************************************************************
+void EventLoop::PollAfter(IPollable& obj, uint32_t delayMicros)
+{
+    _Adopt(obj);
+    _Unregister(obj);
+
+    _wheel.Schedule(obj, _UpdateWheelClock() + _ToTicks(delayMicros));
+}
+
+
+//******************************************************************************
+// Brings the timer wheel tick up to date with micros() and returns it
+//******************************************************************************
+uint32_t EventLoop::_UpdateWheelClock()
+{
+    // Accumulate elapsed microseconds rather than dividing micros() directly, so
+    // that the tick count keeps counting smoothly when micros() wraps around.
+    uint32_t now = micros();
+
+    _wheelRemainder += now - _wheelMicros;
+    _wheelMicros = now;
+
+    _wheelTicks += _wheelRemainder / EVENT_WHEEL_TICK_MICROS;
+    _wheelRemainder %= EVENT_WHEEL_TICK_MICROS;
+
+    // An empty wheel isn't advanced by DispatchEvents(). Keep its time current, so
+    // newly scheduled objects are placed relative to now (and WaitForEvents() gets
+    // an exact due time for them).
+    if (_wheel.Count() == 0) _wheel.Advance(_wheelTicks, _OnDue);
+
+    return _wheelTicks;
+}
+
+
+//******************************************************************************
+// Converts microseconds to timer wheel ticks, rounding up
+//******************************************************************************
+uint32_t EventLoop::_ToTicks(uint32_t micros)
+{
+    uint32_t ticks = micros / EVENT_WHEEL_TICK_MICROS + ((micros % EVENT_WHEEL_TICK_MICROS) != 0);
+
+    return (ticks > 0) ? ticks : 1;
+}
+
+
+//******************************************************************************
+// Polls an object whose scheduled poll time has come, or fires an event timer
+// (timer wheel callback)
+//******************************************************************************
+void EventLoop::_OnDue(TimerWheelNode* pNode)
+{
+#if EVENT_TIMER_POOL_SIZE > 0
+    // Event timers all come from the timer pool; everything else on the wheel
+    // is an IPollable
+    if (_timerPool.Owns(pNode))
+    {
+        _FireTimer(*static_cast<EventTimer*>(pNode));
+        return;
+    }
+#endif
+
+    IPollable& obj = *static_cast<IPollable*>(pNode);
+
+    TRACE(Logger(_classname_) << F("DispatchEvents: Polling due:") << obj.ID() << F(" addr=") << _HEX(PTR(&obj)) << endl);
+
+    EVENT_TRACE(EventTraceType::PollStart, &obj, 0, 0);
+    obj.Poll();
+    EVENT_TRACE(EventTraceType::PollEnd, &obj, 0, 0);
+
+    // Reschedule periodic objects, unless Poll() has already rescheduled or
+    // removed the object. Polls that were missed are skipped, not made up.
+    if (obj._pollPeriod != 0 && !obj.IsScheduled())
+    {
+        EventLoop& loop = *obj._loop;
+        uint32_t dueTick = obj.DueTick() + obj._pollPeriod;
+
+        if ((int32_t)(dueTick - loop._wheelTicks) <= 0) dueTick = loop._wheelTicks + obj._pollPeriod;
+
+        loop._wheel.Schedule(obj, dueTick);
+    }
+}
+
+
+#if EVENT_TIMER_POOL_SIZE > 0
+//******************************************************************************
+// Queues an event after a delay
+//******************************************************************************
+EVENT_TIMER EventLoop::QueueEventAfter(Event& event, uint32_t delayMicros, uint8_t priority)
+{
+    return _StartTimer(event, delayMicros, 0, priority);
+}
+
+
+//******************************************************************************
+// Queues an event periodically
+//******************************************************************************
+EVENT_TIMER EventLoop::QueueEventEvery(Event& event, uint32_t periodMicros, uint8_t priority)
+{
+    return _StartTimer(event, periodMicros, periodMicros, priority);
+}
+
+
+//******************************************************************************
+// Cancels an event timer
+//******************************************************************************
+bool EventLoop::CancelTimer(EVENT_TIMER timer)
+{
+    // The timer may belong to a loop that runs on another thread, so it is only
+    // marked here and handed over to its loop, which takes it off its wheel
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    EventTimer* pTimer = _TimerOf(timer);
+
+    if (pTimer != nullptr)
+    {
+        EventLoop& loop = *pTimer->_loop;
+
+        // Make the handle stale, but keep the block allocated (its serial odd)
+        _timerSerial[_timerPool.IndexOf(pTimer)] += 2;
+
+        pTimer->_isCancelled = true;
+        pTimer->_nextCancelled = loop._cancelledTimers.Load();
+        loop._cancelledTimers.Store(pTimer);
+    }
+
+    interrupts(); // ATOMIC BLOCK END
+
+    return pTimer != nullptr;
+}
+
+
+//******************************************************************************
+// Determines if an event timer is still pending
+//******************************************************************************
+bool EventLoop::IsTimerPending(EVENT_TIMER timer)
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+    bool isPending = _TimerOf(timer) != nullptr;
+    interrupts(); // ATOMIC BLOCK END
+
+    return isPending;
+}
+
+
+//******************************************************************************
+// Allocates and schedules an event timer. The timer takes over the event's 
+// payload reference, if it has one.
+//******************************************************************************
+EVENT_TIMER EventLoop::_StartTimer(Event& event, uint32_t delayMicros, uint32_t periodMicros, uint8_t priority)
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    EventTimer* pTimer = _timerPool.Allocate(this);
+
+    // The handle is the timer's index in the pool (plus one, so it's never 0)
+    // and the serial number of the timer's current use of that block
+    EVENT_TIMER handle = 0;
+
+    if (pTimer != nullptr)
+    {
+        uint8_t index = _timerPool.IndexOf(pTimer);
+
+        handle = ((EVENT_TIMER)++_timerSerial[index] << 8) | (index + 1);
+    }
+
+    interrupts(); // ATOMIC BLOCK END
+
+    if (pTimer == nullptr)
+    {
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        EventPayload::Release(event);
+#endif
+        return 0;
+    }
+
+    pTimer->_event = event;
+    pTimer->_priority = priority;
+    pTimer->_period = (periodMicros != 0) ? _ToTicks(periodMicros) : 0;
+
+    _wheel.Schedule(*pTimer, _UpdateWheelClock() + _ToTicks(delayMicros));
+
+    return handle;
+}
+
+
+//******************************************************************************
+// Queues the event of a timer that has come due, and reschedules or frees the timer
+//******************************************************************************
+void EventLoop::_FireTimer(EventTimer& timer)
+{
+    EventLoop& loop = *timer._loop;
+    Event event = timer._event;
+    uint8_t priority = timer._priority;
+    uint32_t period = timer._period;
+
+    // A cancelled timer is off the wheel now; it's freed with the loop's other 
+    // cancelled timers. A one-shot timer is freed here, unless a CancelTimer() 
+    // on another thread gets to it first.
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    bool isCancelled = timer._isCancelled;
+
+    if (!isCancelled && period == 0) _FreeTimer(timer);
+
+    interrupts(); // ATOMIC BLOCK END
+
+    if (isCancelled) return;
+
+    if (period != 0)
+    {
+        // Like periodic polls, missed firings are skipped, not made up
+        uint32_t dueTick = timer.DueTick() + period;
+
+        if ((int32_t)(dueTick - loop._wheelTicks) <= 0) dueTick = loop._wheelTicks + period;
+
+        loop._wheel.Schedule(timer, dueTick);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        // The timer keeps its own reference for the next firing
+        EventPayload* pPayload = EventPayload::From(event);
+
+        if (pPayload != nullptr) pPayload->AddRef();
+#endif
+    }
+
+    // A one-shot timer hands its payload reference over to the queue
+    loop.Queue(event, priority);
+}
+
+
+//******************************************************************************
+// Takes the timers that have been cancelled off the wheel and frees them
+//******************************************************************************
+void EventLoop::_FreeCancelledTimers()
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+    EventTimer* pTimer = _cancelledTimers.Load();
+    _cancelledTimers.Store(nullptr);
+    interrupts(); // ATOMIC BLOCK END
+
+    while (pTimer != nullptr)
+    {
+        EventTimer* pNext = pTimer->_nextCancelled;
+
+        _wheel.Cancel(*pTimer);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        EventPayload::Release(pTimer->_event);
+#endif
+
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+        _FreeTimer(*pTimer);
+        interrupts(); // ATOMIC BLOCK END
+
+        pTimer = pNext;
+    }
+}
+
+
+//******************************************************************************
+// Returns the timer that a handle refers to, or NULL if the handle is stale or
+// doesn't refer to an allocated timer. Must be called with interrupts disabled.
+//******************************************************************************
+EventTimer* EventLoop::_TimerOf(EVENT_TIMER timer)
+{
+    uint8_t index = (uint8_t)timer - 1;
+    uint8_t serial = (uint8_t)(timer >> 8);
+
+    // The serial number of a block is odd only while it is allocated, so a handle
+    // made up for a free block (e.g., 0x0001) is rejected
+    if (index >= EVENT_TIMER_POOL_SIZE || (serial & 1) == 0 || _timerSerial[index] != serial) return nullptr;
+
+    return _timerPool.At(index);
+}
+
+
+//******************************************************************************
+// Returns a timer to the pool. Bumping the serial number of its block (to an even
+// number) makes the outstanding handles to the timer stale. Must be called with
+// interrupts disabled.
+//******************************************************************************
+void EventLoop::_FreeTimer(EventTimer& timer)
+{
+    _timerSerial[_timerPool.IndexOf(&timer)]++;
+    _timerPool.Free(&timer);
+}
+#endif
+#endif
+
+
+//******************************************************************************
+// Queues an event to the event queue
+//******************************************************************************
+bool EventLoop::Queue(Event& event, uint8_t priority)
+{
+    priority = _LaneOf(event.EventID, priority);
+
+#if EVENT_STATISTICS >= 2
+    event.QueuedAt = micros();
+#endif
+
+    bool isQueued;
+
+#if EVENT_COALESCE_SLOTS > 0
+    if (_IsCoalescing(event)) isQueued = _QueueCoalesced(event, priority);
+    else
+#endif
+    {
+        isQueued = _QueueEvent(event, priority);
+    }
+
+#if EVENT_STATISTICS
+    if (!isQueued) _dropped.FetchAdd(1);
+#endif
+
+#if EVENTFRAMEWORK_HOST
+    // Wake a thread that is waiting in WaitForEvents(). On a microcontroller the
+    // interrupt that queued the event has already woken the processor.
+    if (isQueued) HostPlatform::Wake();
+#endif
+
+    EVENT_TRACE(isQueued ? EventTraceType::Enqueue : EventTraceType::Drop, event.Source, event.EventID, priority);
+
+    return isQueued;
+}
+
+
+//******************************************************************************
+// Adds an event to the queue of a priority lane. With the OverwriteOldest overflow
+// policy, the event the lane drops to make room for it is counted and released
+// (and if it is a coalescing placeholder, so is the event it stands for).
+//******************************************************************************
+inline bool EventLoop::_QueueToLane(const Event& event, uint8_t priority)
+{
+    if (EVENT_QUEUE_OVERFLOW_POLICY != QueueOverflowPolicy::OverwriteOldest) return _queue[priority].Queue(event);
+
+    Event dropped;
+    bool isDropped;
+    bool isQueued = _queue[priority].Queue(event, dropped, isDropped);
+
+    if (isDropped)
+    {
+#if EVENT_COALESCE_SLOTS > 0
+        // A dropped placeholder takes the coalesced event it stands for with it,
+        // and frees its slot so that the next event is queued again
+        if (dropped.Source == _CoalescedSource()) _TakeCoalesced(dropped);
+#endif
+#if EVENT_STATISTICS
+        _dropped.FetchAdd(1);
+#endif
+        EVENT_TRACE(EventTraceType::Drop, dropped.Source, dropped.EventID, priority);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        EventPayload::Release(dropped);
+#endif
+    }
+
+    return isQueued;
+}
+
+
+//******************************************************************************
+// Queues an event to a priority lane as it is (i.e., not coalesced). The event 
+// takes one of its source's queue credits.
+//******************************************************************************
+inline bool EventLoop::_QueueEvent(Event& event, uint8_t priority)
+{
+    bool isQueued;
+
+#if EVENT_SOURCE_QUOTAS
+    // The source's credit is taken first, and given back if the queue is full
+    isQueued = _TakeCredit(event.Source);
+
+    if (isQueued && !_QueueToLane(event, priority))
+    {
+        _ReturnCredit(event.Source);
+        isQueued = false;
+    }
+#else
+    isQueued = _QueueToLane(event, priority);
+#endif
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    if (!isQueued) EventPayload::Release(event);
+#endif
+
+    return isQueued;
+}
+
+
+//******************************************************************************
+// Returns the number of free slots in the queue an event would be queued to
+//******************************************************************************
+uint16_t EventLoop::FreeCapacity(EVENT_ID eventID, uint8_t priority)
+{
+    EventQueueType& queue = _queue[_LaneOf(eventID, priority)];
+
+    return queue.Capacity() - queue.Count();
+}
+
+
+//******************************************************************************
+// Returns the priority lane an event is queued to
+//******************************************************************************
+inline uint8_t EventLoop::_LaneOf(EVENT_ID eventID, uint8_t priority)
+{
+    if (priority == EventPriority::Default) priority = GetEventPriority(eventID);
+
+    return (priority < EVENT_PRIORITY_LANES) ? priority : EVENT_PRIORITY_LANES - 1;
+}
+
+
+#if EVENT_SOURCE_QUOTAS
+//******************************************************************************
+// Takes one of a source's queue credits. Returns false if it has none left.
+//******************************************************************************
+inline bool EventLoop::_TakeCredit(EventSource* pSource)
+{
+    if (pSource == nullptr) return true;
+
+    // The count is reserved before it is checked, so that sources queueing from
+    // ISRs or other threads can't both take the last credit
+    uint16_t pending = pSource->_pending.FetchAdd(1);
+
+    if (pSource->_quota == 0 || pending < pSource->_quota) return true;
+
+    pSource->_pending.FetchAdd((uint16_t)-1);
+
+    return false;
+}
+
+
+//******************************************************************************
+// Gives back the queue credit of a de-queued event
+//******************************************************************************
+inline void EventLoop::_ReturnCredit(EventSource* pSource)
+{
+    if (pSource != nullptr) pSource->_pending.FetchAdd((uint16_t)-1);
+}
+#endif
+
+
+//******************************************************************************
+// De-queues an event from the event queue
+//******************************************************************************
+bool EventLoop::Dequeue(Event& event)
+{
+    TRACE(Logger(_classname_) << F("Dequeue") << endl);
+
+    for (uint8_t lane = 0; lane < EVENT_PRIORITY_LANES; lane++)
+    {
+        if (_queue[lane].Dequeue(event))
+        {
+#if EVENT_COALESCE_SLOTS > 0
+            if (event.Source == _CoalescedSource()) _TakeCoalesced(event);
+            else
+#endif
+            {
+#if EVENT_SOURCE_QUOTAS
+                _ReturnCredit(event.Source);
+#endif
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//******************************************************************************
+// Assigns a priority to an EventCode
+//******************************************************************************
+bool EventLoop::SetEventPriority(uint8_t eventCode, uint8_t priority)
+{
+    for (uint8_t i = 0; i < _priorityMapCount; i++)
+    {
+        if (_priorityMap[i].EventCode == eventCode)
+        {
+            _priorityMap[i].Priority = priority;
+            return true;
+        }
+    }
+
+    if (_priorityMapCount >= EVENT_PRIORITY_MAP_SIZE) return false;
+
+    _priorityMap[_priorityMapCount].EventCode = eventCode;
+    _priorityMap[_priorityMapCount].Priority = priority;
+    _priorityMapCount++;
+
+    return true;
+}
+
+
+//******************************************************************************
+// Returns the priority assigned to an event ID's EventCode
+//******************************************************************************
+uint8_t EventLoop::GetEventPriority(EVENT_ID eventID)
+{
+    // The EventCode is the low byte of the event ID
+    uint8_t eventCode = (uint8_t)eventID;
+
+    for (uint8_t i = 0; i < _priorityMapCount; i++)
+    {
+        if (_priorityMap[i].EventCode == eventCode) return _priorityMap[i].Priority;
+    }
+
+    return EVENT_DEFAULT_PRIORITY;
+}
+
+
+//******************************************************************************
+// Sets the weight of a priority lane
+//******************************************************************************
+void EventLoop::SetLaneWeight(uint8_t priority, uint8_t weight)
+{
+    if (priority < EVENT_PRIORITY_LANES) _laneWeight[priority] = weight;
+}
+
+
+//******************************************************************************
+// Turns coalescing on or off for an event ID
+//******************************************************************************
+bool EventLoop::SetCoalescing(EVENT_ID eventID, bool isCoalescing)
+{
+#if EVENT_COALESCE_SLOTS > 0
+    for (uint8_t i = 0; i < _coalesceMapCount; i++)
+    {
+        if (_coalesceMap[i] == eventID)
+        {
+            if (!isCoalescing) _coalesceMap[i] = _coalesceMap[--_coalesceMapCount];
+            return true;
+        }
+    }
+
+    if (!isCoalescing) return true;
+
+    if (_coalesceMapCount >= EVENT_COALESCE_MAP_SIZE) return false;
+
+    _coalesceMap[_coalesceMapCount++] = eventID;
+
+    return true;
+#else
+    return !isCoalescing;
+#endif
+}
+
+
+#if EVENT_TOPIC_BUCKETS > 0
+//******************************************************************************
+// Subscribes a binding to the events of all of the loop's sources
+//******************************************************************************
+void EventLoop::Subscribe(IEventBinding& binding, EVENT_ID eventID, EVENT_ID eventMask)
+{
+    binding.Unlink();
+
+    binding._eventID = eventID & eventMask;
+    binding._eventMask = eventMask;
+
+    // The chain is chosen once, here, so dispatching doesn't have to look at the
+    // subscriptions that can't match an event's EventSourceID
+    IEventBinding*& first = ((eventMask & EventMask::SourceID) == EventMask::SourceID) ? _TopicBucket(eventID) : _anyTopic;
+
+    binding._nextLink = first;
+    binding._prevLink = &first;
+
+    if (first != nullptr) first->_prevLink = &binding._nextLink;
+
+    first = &binding;
+    TRACE(Logger(_classname_, this) << F("Subscribe: binding=") << _HEX(PTR(&binding)) << F(", eventID=") << _HEX(eventID) << endl);
+}
+
+
+IEventBinding* EventLoop::Subscribe(IEventListener& listener, EVENT_ID eventID, EVENT_ID eventMask, EventBinding* pBinding)
+{
+    if (pBinding == nullptr) pBinding = EventSource::_bindingPool.Allocate<IEventListener&>(listener);
+
+    if (pBinding == nullptr) return nullptr;
+
+    Subscribe(*pBinding, eventID, eventMask);
+
+    return pBinding;
+}
+
+
+IEventBinding* EventLoop::Subscribe(EVENT_LISTENER pfListener, EVENT_ID eventID, EVENT_ID eventMask, StaticEventBinding* pBinding)
+{
+    if (pBinding == nullptr) pBinding = EventSource::_staticBindingPool.Allocate(pfListener);
+
+    if (pBinding == nullptr) return nullptr;
+
+    Subscribe(*pBinding, eventID, eventMask);
+
+    return pBinding;
+}
+
+
+//******************************************************************************
+// Removes a topic subscription
+//******************************************************************************
+void EventLoop::Unsubscribe(IEventBinding& binding)
+{
+    // Topic subscriptions are linked without a source; a binding with a source
+    // belongs to that source. A binding that isn't in this loop's routing table
+    // (e.g., one that has been unsubscribed already and may be back in its pool)
+    // is left alone, so it isn't unlinked or freed twice.
+    if (binding._source != nullptr || !_IsSubscribed(binding)) return;
+
+    binding.Unlink();
+    TRACE(Logger(_classname_, this) << F("Unsubscribe: binding=") << _HEX(PTR(&binding)) << endl);
+
+    EventSource::_FreeBinding(binding);
+}
+
+
+//******************************************************************************
+// Determines if a binding is linked into the loop's routing table
+//******************************************************************************
+bool EventLoop::_IsSubscribed(IEventBinding& binding)
+{
+    if (binding._prevLink == nullptr) return false;
+
+    IEventBinding* pBinding = ((binding._eventMask & EventMask::SourceID) == EventMask::SourceID) ? _TopicBucket(binding._eventID) : _anyTopic;
+
+    for (; pBinding != nullptr; pBinding = pBinding->_nextLink)
+    {
+        if (pBinding == &binding) return true;
+    }
+
+    return false;
+}
+#endif
+
+
+#if EVENT_COALESCE_SLOTS > 0
+//******************************************************************************
+// Determines if an event is to be coalesced
+//******************************************************************************
+bool EventLoop::_IsCoalescing(const Event& event)
+{
+    if (event.Source != nullptr && event.Source->_isCoalescing) return true;
+
+    for (uint8_t i = 0; i < _coalesceMapCount; i++)
+    {
+        if (_coalesceMap[i] == event.EventID) return true;
+    }
+
+    return false;
+}
+
+
+//******************************************************************************
+// Queues a coalesced event.
+// If an event with the same source and event ID is already pending, its data is
+// replaced. Otherwise the event is stored in a free coalescing slot and a
+// placeholder event referring to that slot is queued in its place. The placeholder
+// is only queued once, so the event keeps the priority lane of the first event
+// even if a later one is queued with a different priority.
+//******************************************************************************
+bool EventLoop::_QueueCoalesced(Event& event, uint8_t priority)
+{
+    const uint8_t MASK   = EVENT_COALESCE_SLOTS - 1;
+    const uint8_t PROBES = (EVENT_COALESCE_SLOTS < 4) ? EVENT_COALESCE_SLOTS : 4;
+    const uint8_t NONE   = 0xFF;
+
+    uint8_t hash = (uint8_t)(((uintptr_t)event.Source >> 1) ^ event.EventID ^ (event.EventID >> 8));
+    uint8_t free = NONE;
+    uint8_t claim = SLOT_FREE;
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    Event replaced;
+#endif
+
+    // The index is shared between loop() code and ISRs, so the lookup and the
+    // update must be atomic. The placeholder event is queued after interrupts are
+    // re-enabled (the queue has its own synchronization), so a free slot is only
+    // claimed at first: nobody else coalesces into it until its placeholder has 
+    // been queued, since if that fails the slot is freed again and an event 
+    // coalesced into it in the meantime would be lost.
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    for (uint8_t probe = 0; probe < PROBES; probe++)
+    {
+        uint8_t index = (hash + probe) & MASK;
+        CoalesceSlot& slot = _coalesce[index];
+
+        if (slot.State == SLOT_FREE)
+        {
+            if (free == NONE) free = index;
+        }
+        else if (slot.State == SLOT_PENDING && slot.Value.Source == event.Source && slot.Value.EventID == event.EventID)
+        {
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+            replaced = slot.Value;
+            slot.Value.HasPayload = event.HasPayload;
+#endif
+            slot.Value.Data = event.Data;
+            free = index;
+#if EVENT_STATISTICS
+            _stats.Coalesced++;
+#endif
+            break;
+        }
+    }
+
+    if (free != NONE && _coalesce[free].State == SLOT_FREE)
+    {
+        // The claim tag tells this caller's claim from a later one on the same
+        // slot, in case the placeholder is de-queued before the slot is published
+        if (++_coalesceClaim == SLOT_FREE) _coalesceClaim = SLOT_PENDING + 1;
+
+        claim = _coalesceClaim;
+        _coalesce[free].Value = event;
+        _coalesce[free].State = claim;
+    }
+
+    interrupts(); // ATOMIC BLOCK END
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    EventPayload::Release(replaced);
+#endif
+
+    auto isQueued = true;
+
+    if (free == NONE)
+    {
+        // The index is crowded - queue the event without coalescing it. It is 
+        // de-queued as a real event, so it takes a credit like one.
+        isQueued = _QueueEvent(event, priority);
+    }
+    else if (claim != SLOT_FREE)
+    {
+        Event placeholder((EVENT_ID)free); { placeholder.Source = _CoalescedSource(); }
+
+        isQueued = _QueueToLane(placeholder, priority);
+
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+
+        if (_coalesce[free].State == claim)
+        {
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+            if (!isQueued) replaced = _coalesce[free].Value;
+#endif
+            _coalesce[free].State = isQueued ? SLOT_PENDING : SLOT_FREE;
+        }
+
+        interrupts(); // ATOMIC BLOCK END
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        if (!isQueued) EventPayload::Release(replaced);
+#endif
+    }
+
+    return isQueued;
+}
+
+
+//******************************************************************************
+// Replaces a placeholder event with the coalesced event it stands for and frees
+// its coalescing slot.
+//******************************************************************************
+void EventLoop::_TakeCoalesced(Event& event)
+{
+    CoalesceSlot& slot = _coalesce[event.EventID];
+
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    event = slot.Value;
+    slot.State = SLOT_FREE;
+
+    interrupts(); // ATOMIC BLOCK END
+}
+#endif
+
+
+//******************************************************************************
+// Polls all sources to dispatch events
+//******************************************************************************
+void EventLoop::DispatchEvents()
+{
+#if DEBUG
+    for (auto p = _first; p != nullptr; p = p->_nextObject)
+    {
+        Logger(_classname_) << F("DispatchEvents: ID=") << p->ID() << F(", addr=") << _HEX(PTR(p))<< endl;
+    }
+#endif
+
+    _DispatchPass();
+}
+
+
+//******************************************************************************
+// Polls and dispatches events until a time budget is used up
+//******************************************************************************
+uint32_t EventLoop::DispatchEvents(uint32_t budgetMicros)
+{
+    uint32_t start = micros();
+    IPollable* pIdleStart = nullptr;
+    uint8_t idleStartPolls = 0;
+
+    // Stop early once a whole round of the polling list has found nothing to do;
+    // polling again would just burn the rest of the budget. An object with a poll
+    // weight is polled several times per round, so the round is over when the 
+    // rotation is back at the same object and the same poll of its turn.
+    do
+    {
+        IPollable* pPolled = _current;
+        uint8_t polls = _currentPolls;
+
+        if (_DispatchPass()) pIdleStart = nullptr;
+        else if (pPolled == nullptr || (pPolled == pIdleStart && polls == idleStartPolls)) break;
+        else if (pIdleStart == nullptr) { pIdleStart = pPolled; idleStartPolls = polls; }
+    }
+    while ((uint32_t)(micros() - start) < budgetMicros);
+
+    return micros() - start;
+}
+
+
+//******************************************************************************
+// Sleeps until there is something to do or the timeout expires
+//******************************************************************************
+bool EventLoop::WaitForEvents(uint32_t timeoutMicros)
+{
+    uint32_t start = micros();
+
+    for (;;)
+    {
+        uint32_t sleepMicros;
+
+        // Interrupts stay disabled from the check until the processor sleeps, so an
+        // event queued by an ISR in between can't be missed.
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+
+        if (_HasWork(sleepMicros))
+        {
+            interrupts(); // ATOMIC BLOCK END
+            return true;
+        }
+
+        uint32_t elapsed = micros() - start;
+
+        if (elapsed >= timeoutMicros)
+        {
+            interrupts(); // ATOMIC BLOCK END
+            return false;
+        }
+
+        if (sleepMicros > timeoutMicros - elapsed) sleepMicros = timeoutMicros - elapsed;
+
+        // The sleep function enables interrupts
+        if (_sleepFunction != nullptr) (*_sleepFunction)(sleepMicros);
+        else interrupts(); // ATOMIC BLOCK END
+    }
+}
+
+
+//******************************************************************************
+// Determines if DispatchEvents() has anything to do. If not, gets the number of
+// microseconds until the next scheduled poll is due (0xFFFFFFFF if none is).
+// Must be called with interrupts disabled.
+//******************************************************************************
+bool EventLoop::_HasWork(uint32_t& sleepMicros)
+{
+    // Objects polled round-robin have to be polled all the time
+    if (_first != nullptr || _firstReady != nullptr) return true;
+
+    for (uint8_t lane = 0; lane < EVENT_PRIORITY_LANES; lane++)
+    {
+        if (!_queue[lane].IsEmpty()) return true;
+    }
+
+    sleepMicros = 0xFFFFFFFF;
+
+#if EVENT_SCHEDULED_POLLING
+    uint32_t dueTick;
+
+    if (_wheel.NextDue(dueTick))
+    {
+        uint32_t ticks = dueTick - _UpdateWheelClock();
+
+        if ((int32_t)ticks <= 0) return true;
+
+        if (ticks < 0xFFFFFFFF / EVENT_WHEEL_TICK_MICROS) sleepMicros = ticks * EVENT_WHEEL_TICK_MICROS - _wheelRemainder;
+    }
+#endif
+
+    return false;
+}
+
+
+//******************************************************************************
+// Polls the due objects and the next object in the polling list, and dispatches
+// the queued events. Returns true if there were any events to dispatch.
+//******************************************************************************
+bool EventLoop::_DispatchPass()
+{
+#if EVENT_SCHEDULED_POLLING
+#if EVENT_TIMER_POOL_SIZE > 0
+    // Free the timers that have been cancelled, possibly by other threads
+    if (_cancelledTimers.LoadRelaxed() != nullptr) _FreeCancelledTimers();
+#endif
+
+    // Poll the objects whose scheduled poll time has come.
+    if (_wheel.Count() > 0) _wheel.Advance(_UpdateWheelClock(), _OnDue);
+#endif
+
+    // Poll the objects that have been marked ready.
+    if (_firstReady != nullptr) _PollReady();
+
+    // Poll the next object in the polling list. An object keeps its turn for as
+    // many polls as its poll weight (weighted round-robin), so its polls come in
+    // a burst of consecutive calls.
+    // NOTE: _current is advanced before the object is polled, so that the object
+    // can safely remove itself from the polling list in its Poll() method.
+    if (_current != nullptr)
+    {
+        IPollable* pObj = _current;
+
+        TRACE(Logger(_classname_) << F("DispatchEvents: Polling:") << pObj->ID() << F(" addr=") << _HEX(PTR(pObj))  << endl);
+
+        if (++_currentPolls >= pObj->_pollWeight)
+        {
+            _current = (pObj->_nextObject != nullptr) ? pObj->_nextObject : _first;
+            _currentPolls = 0;
+        }
+
+        EVENT_TRACE(EventTraceType::PollStart, pObj, 0, 0);
+        pObj->Poll();
+        EVENT_TRACE(EventTraceType::PollEnd, pObj, 0, 0);
+    }
+
+    return _DispatchQueuedEvents();
+}
+
+
+//******************************************************************************
+// Dispatches the events in the priority lanes. Returns true if there were any.
+//******************************************************************************
+bool EventLoop::_DispatchQueuedEvents()
+{
+    // Dispatch all events that were queued up to this point.
+    // NOTE: This loop is specifically constructed to only go around the event queue
+    // at most one time. It does NOT dispatch any new events added as a result of
+    // processing a dispatched event. Those will get processed on the next go-around. 
+    // Otherwise, we could create an endless loop where object A posts an event 
+    // that object B receives who, in turn, posts an event that object A receives, 
+    // etc... In such a scenario the event queue would never empty and the dispatch 
+    // loop would go on forever.
+    EventQueueType::index_t count[EVENT_PRIORITY_LANES];
+    uint16_t pending = 0;
+
+    for (uint8_t lane = 0; lane < EVENT_PRIORITY_LANES; lane++) pending += (count[lane] = _queue[lane].Count());
+
+    if (pending == 0) return false;
+
+#if EVENT_STATISTICS
+    // Only the dispatcher removes events from the queue, so the number of pending
+    // events peaks right before a dispatch pass
+    if (pending > _stats.HighWater) _stats.HighWater = pending;
+#endif
+
+    if (EVENT_PRIORITY_SCHEDULING == PriorityScheduling::Strict || EVENT_PRIORITY_LANES == 1)
+    {
+        // Strict: drain each lane before moving on to the next lower one
+        for (uint8_t lane = 0; lane < EVENT_PRIORITY_LANES; lane++)
+        {
+            _DispatchEvents(_queue[lane], count[lane], 0);
+        }
+    }
+    else
+    {
+        // Weighted: go around the lanes in rounds, with each lane dispatching up
+        // to its weight in events per round. By default, each lane gets twice the
+        // weight of the next lower lane.
+        for (bool isPending = true; isPending; )
+        {
+            isPending = false;
+
+            for (uint8_t lane = 0; lane < EVENT_PRIORITY_LANES; lane++)
+            {
+                if (count[lane] == 0) continue;
+
+                auto weight = _laneWeight[lane];
+
+                if (weight == 0)
+                {
+                    uint8_t shift = EVENT_PRIORITY_LANES - 1 - lane;
+                    weight = 1 << ((shift < 7) ? shift : 7);
+                }
+
+                _DispatchEvents(_queue[lane], count[lane], weight);
+
+                isPending |= (count[lane] != 0);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//******************************************************************************
+// De-queues the event at the head of a queue and resolves coalesced events
+//******************************************************************************
+inline bool EventLoop::_TakeEvent(EventQueueType& queue, Event& event)
+{
+    if (!queue.Dequeue(event)) return false;
+
+#if EVENT_COALESCE_SLOTS > 0
+    if (event.Source == _CoalescedSource()) _TakeCoalesced(event);
+    else
+#endif
+    {
+#if EVENT_SOURCE_QUOTAS
+        _ReturnCredit(event.Source);
+#endif
+    }
+
+    EVENT_TRACE(EventTraceType::Dequeue, event.Source, event.EventID, &queue - _queue);
+
+#if EVENT_STATISTICS
+    _RecordDispatch(event);
+#endif
+
+    return true;
+}
+
+
+//******************************************************************************
+// Dispatches up to 'limit' (0 = no limit) of the 'count' events at the head of
+// a queue, decrementing 'count' for each one.
+//******************************************************************************
+inline void EventLoop::_DispatchEvents(EventQueueType& queue, EventQueueType::index_t& count, uint8_t limit)
+{
+#if EVENT_BATCH_SIZE > 0
+    Event batch[EVENT_BATCH_SIZE];
+    uint8_t size = 0;
+#endif
+
+    for (uint8_t n = 0; count > 0 && (limit == 0 || n < limit); count--, n++)
+    {
+#if EVENT_BATCH_SIZE > 0
+        Event& event = batch[size];
+#else
+        Event event;
+#endif
+
+        if (!_TakeEvent(queue, event)) { count = 0; break; }
+
+#if EVENTFRAMEWORK_HOST
+        if (_dispatchHandler != nullptr) { _dispatchHandler(event); continue; }
+#endif
+
+#if EVENT_BATCH_SIZE > 0
+        if (++size == EVENT_BATCH_SIZE) 
+        {
+            _DispatchBatch(batch, size);
+            size = 0;
+        }
+#else
+        if (event.Source != nullptr) event.Source->DispatchEvent(event);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        // All of the source's bindings have seen the event
+        EventPayload::Release(event);
+#endif
+#endif
+    }
+
+#if EVENT_BATCH_SIZE > 0
+    if (size > 0) _DispatchBatch(batch, size);
+#endif
+}
+
+
+#if EVENT_BATCH_SIZE > 0
+//******************************************************************************
+// Dispatches a batch of de-queued events grouped by source. Each source's events
+// stay in the order they were queued, and the groups are dispatched in the order
+// of each source's first event.
+//******************************************************************************
+void EventLoop::_DispatchBatch(Event* pEvents, uint8_t count)
+{
+    for (uint8_t first = 0, last; first < count; first = last)
+    {
+        EventSource* pSource = pEvents[first].Source;
+
+        // Gather the source's events behind its first event
+        last = first + 1;
+
+        for (uint8_t i = last; i < count; i++)
+        {
+            if (pEvents[i].Source != pSource) continue;
+
+            Event event = pEvents[i];
+
+            for (uint8_t j = i; j > last; j--) pEvents[j] = pEvents[j - 1];
+
+            pEvents[last++] = event;
+        }
+
+        if (pSource == nullptr) continue;
+
+        if (last - first == 1) pSource->DispatchEvent(pEvents[first]);
+        else pSource->_DispatchEvents(pEvents + first, last - first);
+    }
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    // All of the sources' bindings have seen the events
+    for (uint8_t i = 0; i < count; i++) EventPayload::Release(pEvents[i]);
+#endif
+}
+#endif
+
+
+#if EVENT_STATISTICS
+//******************************************************************************
+// Gets a snapshot of the runtime statistics
+//******************************************************************************
+void EventLoop::GetStatistics(EventStatistics& stats)
+{
+    stats = _stats;
+    stats.Dropped = _dropped.Load();
+    stats.Capacity = EventQueueType::Capacity() * EVENT_PRIORITY_LANES;
+}
+
+
+//******************************************************************************
+// Resets the runtime statistics
+//******************************************************************************
+void EventLoop::ResetStatistics()
+{
+    memset(&_stats, 0, sizeof(_stats));
+    _dropped.Store(0);
+}
+
+
+//******************************************************************************
+// Updates the statistics for an event that is about to be dispatched
+//******************************************************************************
+#if EVENT_STATISTICS >= 2
+inline void EventLoop::_RecordDispatch(const Event& event)
+#else
+inline void EventLoop::_RecordDispatch(const Event&)
+#endif
+{
+    _stats.Dispatched++;
+
+#if EVENT_STATISTICS >= 2
+    uint32_t latency = micros() - event.QueuedAt;
+
+    if (latency > _stats.MaxLatency) _stats.MaxLatency = latency;
+
+    uint8_t bucket = 0;
+
+    for (uint32_t range = latency >> 4; range != 0 && bucket < EVENT_LATENCY_BUCKETS - 1; range >>= 1) bucket++;
+
+    if (_stats.Latency[bucket] != 0xFFFF) _stats.Latency[bucket]++;
+#endif
+}
+#endif
@@ -0,0 +1,441 @@
+#ifndef _EventLoop_h_
+#define _EventLoop_h_
+
+#include <RTL_StdLib.h>
+#include "EventFrameworkConfig.h"
+#include "IPollable.h"
+#include "Event.h"
+#include "EventCodes.h"
+#include "EventQueue.h"
+#include "LockFreeEventQueue.h"
+#include "TimerWheel.h"
+#include "EventTimer.h"
+#include "ObjectPool.h"
+#include "EventTrace.h"
+#include "IEventListener.h"
+
+
+class IEventBinding;
+class EventBinding;
+class StaticEventBinding;
+
+
+/*******************************************************************************
+Determines the order in which DispatchEvents() drains the event priority lanes.
+*******************************************************************************/
+class PriorityScheduling
+{
+    public: enum
+    {
+        Strict   = 0,   // Each lane is drained completely before the next lower lane
+        Weighted = 1,   // Lanes are drained in rounds; in each round a lane dispatches
+                        // up to its weight in events (see SetLaneWeight())
+    };
+};
+
+
+/// Function that puts the processor to sleep until an interrupt occurs or 'micros'
+/// microseconds have passed (see EventLoop::SetSleepFunction())
+typedef void (*SLEEP_FUNCTION)(uint32_t micros);
+
+
+#if EVENTFRAMEWORK_HOST
+/// Function that takes over the dispatching of de-queued events (see EventLoop::SetDispatchHandler())
+typedef void (*DISPATCH_HANDLER)(Event& event);
+#endif
+
+
+/*******************************************************************************
+Runtime statistics reported by EventLoop::GetStatistics().
+*******************************************************************************/
+struct EventStatistics
+{
+    uint32_t Dispatched;    // Events dispatched from the queue
+    uint32_t Dropped;       // Events that were rejected, or dropped from the queue, because it was full
+    uint32_t Coalesced;     // Events that were merged into an already pending event
+    uint16_t HighWater;     // The most events that have been pending at once (all lanes)
+    uint16_t Capacity;      // The capacity of the queue (all lanes)
+
+#if EVENT_STATISTICS >= 2
+    uint32_t MaxLatency;    // The longest time an event has waited in the queue, in microseconds
+
+    /// Enqueue-to-dispatch latency histogram. Bucket 0 counts latencies below 16us
+    /// and each following bucket covers twice the range of the one before it. 
+    /// The counts saturate at 65535.
+    uint16_t Latency[EVENT_LATENCY_BUCKETS];
+#endif
+};
+
+
+/*******************************************************************************
+A scheduler and event dispatcher.
+
+An EventLoop polls objects and dispatches their events. Objects that implement
+IPollable belong to one event loop, which periodically invokes their Poll() method,
+either round-robin or when the object's scheduled poll time comes around, and
+dispatches the events they queue. The loop's DispatchEvents() method must be
+invoked in the sketch's loop() method (or, on the host, by the loop's thread).
+
+Each EventLoop has its own event queue, polling list, timer wheel and runtime 
+configuration (priorities, coalescing, statistics). Objects are added to the 
+default loop (see EventDispatcher) when they are created; Add() moves an object
+to another loop. Giving a subsystem its own loop isolates it: a burst of events
+from one subsystem can't fill another subsystem's queue or hold up its polling.
+The sizes of the queues, pools and indexes are the same for all loops (see 
+EventFrameworkConfig.h).
+
+Queued events are held in EVENT_PRIORITY_LANES priority lanes, so urgent events
+(e.g., Obstacle or Aborted) don't have to wait behind a backlog of routine ones. 
+The lane for an event is either given when it is queued or assigned per EventCode 
+with SetEventPriority().
+
+State-update events for which only the latest value matters can be coalesced,
+either per EventID (SetCoalescing()) or per source (EventSource::SetCoalescing()).
+While a coalesced event is pending in the queue, queueing another event with the
+same source and event ID just replaces the pending event's data instead of taking
+another queue slot. The pending event keeps its place in the queue and the 
+priority lane of the first event, even if a later event is queued with a higher 
+priority. The pending events are found through a small hash index of 
+EVENT_COALESCE_SLOTS entries, so replacement is O(1).
+
+Topic subscriptions (Subscribe()) receive the matching events of every source in
+the loop, so a supervisor or telemetry listener doesn't have to attach itself to
+each source. A subscription whose mask covers the EventSourceID is routed through
+EVENT_TOPIC_BUCKETS lists indexed by the EventSourceID, and all others (e.g., 
+every event with a given EventCode) through a single wildcard list. Dispatching
+an event only walks the wildcard list and the one list for its EventSourceID.
+A topic listener is called from the dispatch of each source it matches, so with
+host/ParallelDispatcher it can be called from several worker threads at once.
+*******************************************************************************/
+class EventLoop
+{
+    DECLARE_CLASSNAME;
+
+    friend class EventSource;
+
+    /// The type of the event queue, as configured in EventFrameworkConfig.h
+    public: typedef SelectEventQueue<EVENT_QUEUE_MODEL, EVENT_QUEUE_SIZE, EVENT_QUEUE_OVERFLOW_POLICY>::type EventQueueType;
+
+    /***************************************************************************
+     Constructors
+    ***************************************************************************/
+    public: EventLoop();
+
+    /***************************************************************************
+    Public Methods
+    ***************************************************************************/
+
+    /// Polls the registered poll-able objects.
+    /// This method must be called from the Sketch's loop() method.
+    public: void DispatchEvents();
+
+    /// Keeps polling the registered poll-able objects and dispatching events until
+    /// 'budgetMicros' microseconds have passed, or until a whole round of polling
+    /// finds nothing to do. Returns the number of microseconds used, which can 
+    /// exceed the budget by the time it takes to poll one object and dispatch the
+    /// events it queued.
+    public: uint32_t DispatchEvents(uint32_t budgetMicros);
+
+    /// Waits until an event is queued, an object is marked ready or the next scheduled
+    /// poll is due, or until 'timeoutMicros' microseconds have passed. Returns false
+    /// if the timeout expired. Returns immediately if there is anything to do already,
+    /// including when any object is polled round-robin (see IPollable). Call it in
+    /// loop() after DispatchEvents() to sleep rather than spin while idle.
+    public: bool WaitForEvents(uint32_t timeoutMicros);
+
+    /// Sets the function WaitForEvents() uses to sleep. It is called with interrupts
+    /// disabled and must enable them and sleep atomically (e.g., on AVR with 
+    /// sleep_enable(); interrupts(); sleep_cpu(); sleep_disable();), so an interrupt
+    /// that queues an event in between always wakes it. NULL (the default on a 
+    /// microcontroller) makes WaitForEvents() busy-wait; on the host the default
+    /// is HostPlatform::Sleep().
+    public: void SetSleepFunction(SLEEP_FUNCTION pfSleep) { _sleepFunction = pfSleep; };
+
+    /// Adds a poll-able object to the round-robin polling list. An object that 
+    /// belongs to another event loop is moved to this one.
+    public: void Add(IPollable& obj);
+
+    /// Adds a poll function. The IPollable wrapper for the function comes from a
+    /// fixed-size pool; returns NULL if the pool is exhausted.
+    public: IPollable* Add(POLL_FUNCTION pfPollFunction);
+
+    /// Removes a poll-able object. The object still belongs to the loop, but isn't
+    /// polled until it is added or scheduled again. A wrapper created by 
+    /// Add(POLL_FUNCTION) is returned to its pool.
+    public: void Remove(IPollable& obj);
+
+#if EVENT_SCHEDULED_POLLING
+    /// Polls an object every 'periodMicros' microseconds instead of round-robin.
+    /// A period of 0 returns the object to round-robin polling.
+    public: void SetPollPeriod(IPollable& obj, uint32_t periodMicros);
+
+    /// Polls an object once, 'delayMicros' microseconds from now, instead of
+    /// round-robin.
+    public: void PollAfter(IPollable& obj, uint32_t delayMicros);
+#endif
+
+    /// Polls an object only after it has been marked ready, instead of round-robin
+    public: void PollWhenReady(IPollable& obj);
+
+    /// Marks an object as ready, so it is polled on the next call to DispatchEvents().
+    /// Can be called from an ISR.
+    public: void SetReady(IPollable& obj);
+
+    /// Queues an event to the event queue with the given priority.
+    /// Returns false if the event could not be queued (i.e., the queue is full or
+    /// the event's source has used up its quota).
+    public: bool Queue(Event& event, uint8_t priority=EventPriority::Default);
+
+    /// Returns the number of free slots in the queue that an event with the given
+    /// event ID and priority would be queued to
+    public: uint16_t FreeCapacity(EVENT_ID eventID, uint8_t priority=EventPriority::Default);
+
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+    /// Queues an event once, 'delayMicros' microseconds from now. Returns a handle
+    /// for CancelTimer(), or 0 if the timer pool is exhausted. Like SetPollPeriod(),
+    /// it must be called from the code that runs the loop (e.g., from Poll()).
+    public: EVENT_TIMER QueueEventAfter(Event& event, uint32_t delayMicros, uint8_t priority=EventPriority::Default);
+
+    /// Queues an event every 'periodMicros' microseconds, starting one period from
+    /// now, until the timer is cancelled. Returns a handle for CancelTimer(), or 0
+    /// if the timer pool is exhausted. Must be called from the code that runs the loop.
+    public: EVENT_TIMER QueueEventEvery(Event& event, uint32_t periodMicros, uint8_t priority=EventPriority::Default);
+
+    /// Cancels an event timer of any loop, from any thread. Returns false if the 
+    /// handle is stale (i.e., the timer has fired once and for all or has been 
+    /// cancelled already). The timer doesn't fire after this returns (unless its
+    /// loop is firing it on another thread at that moment); its loop returns it to
+    /// the pool on its next DispatchEvents(). Not to be called from an ISR.
+    public: static bool CancelTimer(EVENT_TIMER timer);
+
+    /// Determines if an event timer is still pending
+    public: static bool IsTimerPending(EVENT_TIMER timer);
+#endif
+
+    /// De-queues the highest priority event from the event queue. The caller takes
+    /// over the event's payload reference (see EventPayload), if it has one.
+    public: bool Dequeue(Event& event);
+
+    /// Assigns the priority used for events with the given EventCode that are 
+    /// queued with the default priority.
+    /// Returns false if the priority map is full.
+    public: bool SetEventPriority(uint8_t eventCode, uint8_t priority);
+
+    /// Returns the priority assigned to an event ID's EventCode
+    public: uint8_t GetEventPriority(EVENT_ID eventID);
+
+    /// Sets the number of events a lane may dispatch per round when the lanes are
+    /// drained with PriorityScheduling::Weighted
+    public: void SetLaneWeight(uint8_t priority, uint8_t weight);
+
+#if EVENT_STATISTICS
+    /// Gets a snapshot of the runtime statistics
+    public: void GetStatistics(EventStatistics& stats);
+
+    /// Resets the runtime statistics
+    public: void ResetStatistics();
+#endif
+
+    /// Turns coalescing on or off for all events with the given event ID.
+    /// Returns false if the coalescing map is full.
+    public: bool SetCoalescing(EVENT_ID eventID, bool isCoalescing=true);
+
+#if EVENT_TOPIC_BUCKETS > 0
+    /// Subscribes a binding to the events of all of the loop's sources whose IDs
+    /// match 'eventID' in the bits selected by 'eventMask' (e.g., EventMask::SourceID
+    /// for every event of a class of sources). The binding is detached from the 
+    /// source or loop it was attached to. The overloads that take a listener create 
+    /// a binding for it (unless one is given) from the EventSource binding pools, 
+    /// and return NULL if the pool is exhausted.
+    public: void Subscribe(IEventBinding& binding, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact);
+    public: IEventBinding* Subscribe(IEventListener& listener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, EventBinding* pBinding=NULL);
+    public: IEventBinding* Subscribe(EVENT_LISTENER pfListener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, StaticEventBinding* pBinding=NULL);
+
+    /// Removes a topic subscription. A binding that was created by Subscribe() is
+    /// returned to its pool. Does nothing if the binding isn't subscribed at this loop.
+    public: void Unsubscribe(IEventBinding& binding);
+#endif
+
+#if EVENTFRAMEWORK_HOST
+    /// Hands the events de-queued by DispatchEvents() to a handler rather than 
+    /// dispatching them to their sources (NULL restores normal dispatching). The 
+    /// handler takes over the event's payload reference, if it has one. Used by
+    /// the host's ParallelDispatcher (see host/ParallelDispatcher.h).
+    public: void SetDispatchHandler(DISPATCH_HANDLER handler) { _dispatchHandler = handler; };
+#endif
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+    private: void _Adopt(IPollable& obj);
+
+    private: void _Detach(IPollable& obj);
+
+    private: void _Unregister(IPollable& obj);
+
+    private: bool _DispatchPass();
+
+    private: bool _HasWork(uint32_t& sleepMicros);
+
+    private: void _PollReady();
+
+    private: bool _DispatchQueuedEvents();
+
+    private: inline uint8_t _LaneOf(EVENT_ID eventID, uint8_t priority);
+
+    private: inline bool _QueueEvent(Event& event, uint8_t priority);
+
+    private: inline bool _QueueToLane(const Event& event, uint8_t priority);
+
+#if EVENT_SOURCE_QUOTAS
+    private: static inline bool _TakeCredit(EventSource* pSource);
+
+    private: static inline void _ReturnCredit(EventSource* pSource);
+#endif
+
+#if EVENT_STATISTICS
+    private: inline void _RecordDispatch(const Event& event);
+#endif
+
+#if EVENT_SCHEDULED_POLLING
+    private: uint32_t _UpdateWheelClock();
+
+    private: uint32_t _ToTicks(uint32_t micros);
+
+    private: static void _OnDue(TimerWheelNode* pNode);
+
+#if EVENT_TIMER_POOL_SIZE > 0
+    private: EVENT_TIMER _StartTimer(Event& event, uint32_t delayMicros, uint32_t periodMicros, uint8_t priority);
+
+    private: static void _FireTimer(EventTimer& timer);
+
+    private: static EventTimer* _TimerOf(EVENT_TIMER timer);
+
+    private: static void _FreeTimer(EventTimer& timer);
+
+    private: void _FreeCancelledTimers();
+#endif
+#endif
+
+    private: inline bool _TakeEvent(EventQueueType& queue, Event& event);
+
+    private: inline void _DispatchEvents(EventQueueType& queue, EventQueueType::index_t& count, uint8_t limit);
+
+#if EVENT_BATCH_SIZE > 0
+    private: void _DispatchBatch(Event* pEvents, uint8_t count);
+#endif
+
+#if EVENT_COALESCE_SLOTS > 0
+    private: bool _IsCoalescing(const Event& event);
+
+    private: bool _QueueCoalesced(Event& event, uint8_t priority);
+
+    private: void _TakeCoalesced(Event& event);
+
+    /// The source of a placeholder event that stands in for a coalesced event in
+    /// the event queue. Its event ID is the coalescing slot of the real event.
+    private: EventSource* _CoalescedSource() { return (EventSource*)(void*)_coalesce; };
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+    private: bool _IsSubscribed(IEventBinding& binding);
+
+    /// Returns the routing table chain of the subscriptions to an event's EventSourceID
+    private: IEventBinding*& _TopicBucket(EVENT_ID eventID) { return _topic[(eventID >> 8) & (EVENT_TOPIC_BUCKETS - 1)]; };
+#endif
+
+    /***************************************************************************
+    Internal state
+    ***************************************************************************/
+    /// The event queues, one per priority lane
+    private: EventQueueType _queue[EVENT_PRIORITY_LANES];   // size = 66-74 bytes per lane, depending on EVENT_QUEUE_MODEL
+
+    /// The per-lane weights used with PriorityScheduling::Weighted
+    private: uint8_t _laneWeight[EVENT_PRIORITY_LANES];
+
+    /// EventCodes with an assigned priority
+    private: struct PriorityMapEntry { uint8_t EventCode; uint8_t Priority; };
+    private: PriorityMapEntry _priorityMap[EVENT_PRIORITY_MAP_SIZE];
+    private: uint8_t _priorityMapCount;
+
+#if EVENT_COALESCE_SLOTS > 0
+    /// The coalescing index. Each slot holds the latest value of a pending coalesced event.
+    /// A slot's State is SLOT_FREE, SLOT_PENDING, or the claim tag of the caller that
+    /// has stored an event in it and is queueing its placeholder.
+    private: struct CoalesceSlot { Event Value; volatile uint8_t State; };
+    private: CoalesceSlot _coalesce[EVENT_COALESCE_SLOTS];
+
+    /// The last claim tag handed out
+    private: uint8_t _coalesceClaim;
+
+    /// Event IDs that are coalesced
+    private: EVENT_ID _coalesceMap[EVENT_COALESCE_MAP_SIZE];
+    private: uint8_t _coalesceMapCount;
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+    /// The topic routing table: the binding chains of topic subscriptions that 
+    /// match a single EventSourceID, indexed by it, and of all other subscriptions
+    private: IEventBinding* _topic[EVENT_TOPIC_BUCKETS];    // size = 2*EVENT_TOPIC_BUCKETS
+    private: IEventBinding* _anyTopic;          // size = 2
+#endif
+
+    /// The first and last objects in the loop's polling list (doubly-linked list)
+    private: IPollable* _first;                 // size = 2
+    private: IPollable* _last;                  // size = 2
+
+    /// The current object being polled, and the number of times it has been polled
+    /// on its current turn
+    private: IPollable* _current;               // size = 2
+    private: uint8_t _currentPolls;             // size = 1
+
+    /// The objects that have been marked ready (singly-linked list, shared with ISRs)
+    private: IPollable* volatile _firstReady;   // size = 2
+    private: IPollable* volatile _lastReady;    // size = 2
+    private: volatile uint16_t _readyCount;     // size = 2
+
+    /// The function WaitForEvents() uses to sleep
+    private: SLEEP_FUNCTION _sleepFunction;     // size = 2
+
+#if EVENT_STATISTICS
+    /// The runtime statistics. Events can be dropped in ISRs, so that counter is
+    /// kept separately and updated atomically; everything else is only updated 
+    /// by the code that de-queues events (or while interrupts are disabled).
+    private: EventStatistics _stats;
+    private: AtomicValue<uint32_t> _dropped;
+#endif
+
+#if EVENTFRAMEWORK_HOST
+    /// The function that de-queued events are handed to, if any
+    private: DISPATCH_HANDLER _dispatchHandler;
+#endif
+
+    /// The pool of wrappers for poll functions
+    private: static ObjectPool<PollableDelegate, EVENT_DELEGATE_POOL_SIZE> _delegatePool;
+
+#if EVENT_SCHEDULED_POLLING
+    /// The timer wheel that schedules objects with a poll period or due time, and
+    /// event timers
+    private: TimerWheel _wheel;                 // size = 102 (default configuration)
+
+    /// The current timer wheel tick, and the value of micros() and the number of
+    /// microseconds not yet accounted for when it was last updated
+    private: uint32_t _wheelTicks;              // size = 4
+    private: uint32_t _wheelMicros;             // size = 4
+    private: uint32_t _wheelRemainder;          // size = 4
+
+#if EVENT_TIMER_POOL_SIZE > 0
+    /// The timers that have been cancelled and are still to be taken off the
+    /// wheel and freed (shared with the threads of other loops)
+    private: AtomicValue<EventTimer*> _cancelledTimers;    // size = 2
+
+    /// The pool of event timers, and the serial number of the current use of each
+    /// of its blocks, which is odd while the block is allocated. They are shared by
+    /// all loops, so they are only accessed with interrupts disabled.
+    private: static ObjectPool<EventTimer, EVENT_TIMER_POOL_SIZE> _timerPool;
+    private: static uint8_t _timerSerial[EVENT_TIMER_POOL_SIZE];
+#endif
+#endif
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*******************************************************************************
+A reference-counted, fixed-size event payload. See EventPayload.h for details.
+*******************************************************************************/
+#include <Arduino.h>
+#include "EventPayload.h"
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+
+ObjectPool<EventPayload, EVENT_PAYLOAD_POOL_SIZE> EventPayload::_pool;
+
+
+//******************************************************************************
+// Allocates a payload with a single reference
+//******************************************************************************
+EventPayload* EventPayload::Allocate()
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    EventPayload* pPayload = _pool.Allocate<uint8_t>(1);
+
+    interrupts(); // ATOMIC BLOCK END
+
+    return pPayload;
+}
+
+
+//******************************************************************************
+// Adds a reference to the payload
+//******************************************************************************
+void EventPayload::AddRef()
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    _references++;
+
+    interrupts(); // ATOMIC BLOCK END
+}
+
+
+//******************************************************************************
+// Releases a reference to the payload
+//******************************************************************************
+void EventPayload::Release()
+{
+    noInterrupts(); // ATOMIC BLOCK BEGIN
+
+    if (_references > 0 && --_references == 0) _pool.Free(this);
+
+    interrupts(); // ATOMIC BLOCK END
+}
+
+#endif
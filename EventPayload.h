@@ -0,0 +1,95 @@
+#ifndef _EventPayload_h_
+#define _EventPayload_h_
+
+#include <Arduino.h>
+#include "EventFrameworkConfig.h"
+#include "Event.h"
+#include "ObjectPool.h"
+
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+
+/*******************************************************************************
+A reference-counted, fixed-size event payload.
+
+Event::Data only holds 4 bytes. Larger payloads (e.g., a scan of sonar readings)
+are passed as a pointer to an EventPayload block allocated from a fixed pool (the
+event's HasPayload flag marks it as such), without copying the data and without
+the producer having to know when the listeners are done with it:
+
+    EventPayload* pPayload = EventPayload::Allocate();
+
+    if (pPayload != NULL)
+    {
+        memcpy(pPayload->Data, readings, sizeof(readings));
+        pPayload->Length = sizeof(readings);
+
+        Event event(SonarScan, pPayload);
+
+        QueueEvent(event);
+    }
+
+A newly allocated payload has one reference, which is handed over to the event
+queue by QueueEvent(). The event loop releases the reference once the event
+has been dispatched to all of the source's bindings, which returns the block to
+the pool. The reference is also released if the event could not be queued, or if
+it is dropped or replaced in the queue (by the OverwriteOldest or Coalesce overflow
+policies or by coalescing). Listeners get the payload with EventPayload::From()
+and must call AddRef() (and later Release()) if they keep it after OnEvent()
+returns.
+
+Events de-queued by the application itself with EventLoop::Dequeue() keep
+their reference; the application must release it.
+
+The pool can be used from ISRs.
+*******************************************************************************/
+class EventPayload      // size = EVENT_PAYLOAD_SIZE + 3
+{
+    friend class ObjectPool<EventPayload, EVENT_PAYLOAD_POOL_SIZE>;
+
+    /// The payload data
+    public: uint8_t Data[EVENT_PAYLOAD_SIZE];
+
+    /// The number of bytes of Data in use (set by the producer)
+    public: uint16_t Length;
+
+    /// Allocates a payload with a single reference. Returns NULL if the pool is exhausted.
+    public: static EventPayload* Allocate();
+
+    /// Returns the payload of an event, or NULL if the event has no pooled payload
+    public: static EventPayload* From(const Event& event)
+    {
+        return event.HasPayload ? static_cast<EventPayload*>(event.Data.Pointer) : NULL;
+    };
+
+    /// Releases the reference held by an event, if the event has a pooled payload
+    public: static void Release(const Event& event)
+    {
+        if (event.HasPayload) static_cast<EventPayload*>(event.Data.Pointer)->Release();
+    };
+
+    /// The number of allocated payloads
+    public: static uint16_t Count() { return _pool.Count(); };
+
+    /// The capacity of the payload pool
+    public: static uint16_t Capacity() { return EVENT_PAYLOAD_POOL_SIZE; };
+
+    /// Adds a reference to the payload
+    public: void AddRef();
+
+    /// Releases a reference to the payload. The payload is returned to the pool
+    /// when the last reference is released.
+    public: void Release();
+
+    private: EventPayload(uint8_t references) : Length(0), _references(references) {};
+
+    /// The number of references to the payload
+    private: uint8_t _references;
+
+    /// The payload pool
+    private: static ObjectPool<EventPayload, EVENT_PAYLOAD_POOL_SIZE> _pool;
+};
+
+#endif
+
+#endif
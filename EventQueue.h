@@ -0,0 +1,252 @@
+#ifndef _EventQueue_h_
+#define _EventQueue_h_
+
+#include <Arduino.h>
+#include "Event.h"
+#include "EventPayload.h"
+
+
+/*******************************************************************************
+Determines what an EventQueue does when an event is queued while it is full.
+*******************************************************************************/
+class QueueOverflowPolicy
+{
+    public: enum
+    {
+        RejectNewest    = 0,    // The new event is rejected (Queue() returns false)
+        OverwriteOldest = 1,    // The oldest queued event is dropped to make room
+        Coalesce        = 2,    // The new event replaces a queued event with the same
+                                // source and event ID; if there is none it is rejected
+    };
+};
+
+
+/*******************************************************************************
+Selects how the event queue is synchronized between the code that queues events
+and the code that de-queues them.
+*******************************************************************************/
+class EventQueueModel
+{
+    public: enum
+    {
+        Guarded         = 0,    // Interrupts are disabled while the queue is manipulated (EventQueue)
+        SingleProducer  = 1,    // Lock-free, one producer and one consumer (SpscEventQueue)
+        MultiProducer   = 2,    // Lock-free, many producers and one consumer (MpscEventQueue)
+    };
+};
+
+
+/// Selects the smallest index type that can address a queue of a given size
+template<bool SMALL> struct _EventQueueIndex        { typedef uint16_t type; };
+template<>           struct _EventQueueIndex<true>  { typedef uint8_t  type; };
+
+
+/*******************************************************************************
+A fixed-capacity circular queue of events.
+
+The capacity is set at compile time and must be a power of two so that the head
+and tail indexes can wrap with a mask rather than a modulo operation. The overflow
+policy (see QueueOverflowPolicy) is also set at compile time.
+
+Events can be queued both from normal code and from interrupt service routines, 
+so the queue manipulation is protected by disabling interrupts.
+*******************************************************************************/
+template<uint16_t SIZE, uint8_t POLICY=QueueOverflowPolicy::RejectNewest>
+class EventQueue
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "EventQueue size must be a power of two");
+    static_assert(SIZE <= 32768, "EventQueue size is too large");
+
+    public: typedef typename _EventQueueIndex<(SIZE <= 128)>::type index_t;
+
+    private: static const index_t MASK = SIZE - 1;
+
+    /***************************************************************************
+    Constructors
+    ***************************************************************************/
+    public: EventQueue() : _head(0), _tail(0), _count(0) {};
+
+    /***************************************************************************
+    Public Methods
+    ***************************************************************************/
+
+    /// The capacity of the queue
+    public: static index_t Capacity() { return SIZE; };
+
+    /// The number of events in the queue
+    public: index_t Count() const { return _count; };
+
+    /// Determines if the queue is empty
+    public: bool IsEmpty() const { return _count == 0; };
+
+    /// Adds an event to the tail of the queue.
+    /// Returns false if the event could not be queued.
+    public: bool Queue(const Event& event)
+    {
+        Event dropped;
+        bool isDropped;
+        bool isQueued = Queue(event, dropped, isDropped);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        if (isDropped) EventPayload::Release(dropped);
+#endif
+
+        return isQueued;
+    };
+
+    /// Adds an event to the tail of the queue, and reports the event that was
+    /// dropped to make room for it (QueueOverflowPolicy::OverwriteOldest). The 
+    /// dropped event is copied to 'dropped' and the caller takes over its payload.
+    /// Returns false if the event could not be queued.
+    public: bool Queue(const Event& event, Event& dropped, bool& isDropped)
+    {
+        /*
+        Interrupts MUST be disabled while an event is being queued to ensure stability
+        while the queue is being manipulated. But, disabling interrupts MUST come
+        BEFORE the queue-full check is done.
+
+        If the queue-full check is FALSE and an asynchronous interrupt queues an
+        event while that check is being made, thus making the queue full, the current
+        insert operation will then corrupt the queue because it will add an event to
+        an already full queue. So the entire operation, from the queue-full check to
+        completing the insert must be atomic.
+
+        Note that this race condition can only happen when an event is queued by normal
+        (non-interrupt) code and simultaneously an interrupt also tries to queue an event.
+        In the case where only normal code is queueing events, this can't happen because
+        all normal code executes synchronously on a single thread. Conversely, if only
+        interrupts are queueing events, it can't happen either because further interrupts 
+        are blocked while the current interrupt is being serviced. In the general case, 
+        however, we have to assume that events could enter the queue both ways. So, 
+        to protect against this race condition we have to disable interrupts.
+
+        Contrast this with the logic in the Dequeue() method.
+        */
+
+        auto isQueued = true;
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        // The payload of an event that is replaced is released after interrupts
+        // are re-enabled
+        Event replaced;
+#endif
+
+        isDropped = false;
+
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+
+        if (_count < SIZE)
+        {
+            _Insert(event);
+        }
+        else if (POLICY == QueueOverflowPolicy::OverwriteOldest)
+        {
+            dropped = _queue[_head];
+            isDropped = true;
+            _head = (_head + 1) & MASK;
+            _count--;
+            _Insert(event);
+        }
+        else if (POLICY == QueueOverflowPolicy::Coalesce)
+        {
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+            isQueued = _Replace(event, replaced);
+#else
+            isQueued = _Replace(event);
+#endif
+        }
+        else
+        {
+            isQueued = false;
+        }
+
+        interrupts(); // ATOMIC BLOCK END
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+        EventPayload::Release(replaced);
+#endif
+
+        return isQueued;
+    };
+
+    /// Removes the event at the head of the queue.
+    /// Returns false if the queue is empty.
+    public: bool Dequeue(Event& event)
+    {
+        /*
+        Interrupts MUST be disabled while an event is being de-queued to ensure
+        stability while the queue is being manipulated. HOWEVER, disabling interrupts
+        MUST come AFTER the queue-empty check.
+
+        There is no harm if the queue-empty check produces an "incorrect" TRUE 
+        response while an asynchronous interrupt queues. It will just pick up that
+        event the next time Dequeue() is called.
+
+        However, If interrupts are suppressed before the queue-empty check, we pretty
+        much lock-up the system. This is because Dequeue() is normally called inside
+        loop(), which means it is called VERY OFTEN.  Most of the time (>99%), the
+        event queue will be empty. But that means that we'll have interrupts turned
+        off for a significant fraction of time and we don't want to do that. Instead,
+        interrupts should only be turned off when we actually have an event to de-queue.
+
+        Contrast this with the logic in the Queue() method.
+        */
+
+        if (_count == 0) return false;
+
+        noInterrupts(); // ATOMIC BLOCK BEGIN
+
+        event = _queue[_head];
+        _head = (_head + 1) & MASK;
+        _count--;
+
+        interrupts(); // ATOMIC BLOCK END
+
+        return true;
+    };
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+    private: inline void _Insert(const Event& event)
+    {
+        _queue[_tail] = event;
+        _tail = (_tail + 1) & MASK;
+        _count++;
+    };
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+    private: inline bool _Replace(const Event& event, Event& replaced)
+#else
+    private: inline bool _Replace(const Event& event)
+#endif
+    {
+        for (index_t i = 0, slot = _head; i < _count; i++, slot = (slot + 1) & MASK)
+        {
+            if (_queue[slot].Source == event.Source && _queue[slot].EventID == event.EventID)
+            {
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+                replaced = _queue[slot];
+                _queue[slot].HasPayload = event.HasPayload;
+#endif
+                _queue[slot].Data = event.Data;
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    /***************************************************************************
+    Internal state
+    ***************************************************************************/
+    /// The event queue 
+    private: Event _queue[SIZE];                // size = sizeof(Event)*SIZE
+
+    /// The event queue head and tail indexes
+    private: volatile index_t _head;
+    private: volatile index_t _tail;
+    private: volatile index_t _count;
+};
+
+#endif
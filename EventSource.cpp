@@ -10,18 +10,64 @@ A base class for an object that sources events.
 
 EVENT_ID EventSource::_nextEventID = EventSourceID::CustomEvent | EventCode::DefaultEvent;
 
+ObjectPool<EventBinding, EVENT_BINDING_POOL_SIZE> EventSource::_bindingPool;
+ObjectPool<StaticEventBinding, EVENT_STATIC_BINDING_POOL_SIZE> EventSource::_staticBindingPool;
+ObjectPool<BatchEventBinding, EVENT_BATCH_BINDING_POOL_SIZE> EventSource::_batchBindingPool;
+
 
 DEFINE_CLASSNAME(EventSource);
 
 
+#if EVENT_BINDING_BUCKETS > 0
+static_assert((EVENT_BINDING_BUCKETS & (EVENT_BINDING_BUCKETS - 1)) == 0, "EVENT_BINDING_BUCKETS must be a power of two");
+
+/// The bucket index for an exact event ID. The EventCode (low byte) is what varies
+/// most between the events of a single source, so it dominates the hash.
+#define BUCKET_OF(eventID) (((eventID) ^ ((eventID) >> 8)) & (EVENT_BINDING_BUCKETS - 1))
+#endif
+
+
+EventSource::EventSource() : _firstBinding(NULL), _isCoalescing(false)
+{
+    _id = "?";
+
+#if EVENT_BINDING_BUCKETS > 0
+    for (uint8_t i = 0; i < EVENT_BINDING_BUCKETS; i++) _bucket[i] = NULL;
+#endif
+
+#if EVENT_SOURCE_STATISTICS
+    _queuedCount = 0;
+    _droppedCount = 0;
+#endif
+
+#if EVENT_SOURCE_QUOTAS
+    _quota = 0;
+#endif
+}
+
+
 //******************************************************************************
 // Add an event binding to this EventSource's list of bindings
 //******************************************************************************
 void EventSource::Attach(IEventBinding& binding)
 {
+    // A binding that is already attached to this source is left alone. A binding
+    // can only be attached to one source at a time, so if it is attached to 
+    // another source it is moved.
+    if (binding._source == this) return;
+
+    binding.Unlink();
+
+    IEventBinding*& first = _BindingList(binding);
+
     // Insert the new binding at the head of the linked list
-    binding._nextLink = (_firstBinding != NULL) ? _firstBinding : NULL;
-    _firstBinding = &binding;
+    binding._nextLink = first;
+    binding._prevLink = &first;
+    binding._source = this;
+
+    if (first != NULL) first->_prevLink = &binding._nextLink;
+
+    first = &binding;
     TRACE(Logger(_classname_, this) << F("Attach: binding=") << _HEX(PTR(&binding)) << endl);
 }
 
@@ -33,12 +79,16 @@ IEventBinding* EventSource::Attach(IEventListener& listener, EventBinding* pBind
 {
     if (pBinding == NULL)
     {
-        for (auto pBinding = (EventBinding*)_firstBinding; pBinding != NULL; pBinding = (EventBinding*)pBinding->_nextLink)
+        // Bindings created for listeners are not subscribed to specific events, so
+        // they are all in the _firstBinding chain
+        for (auto pLink = _firstBinding; pLink != NULL; pLink = pLink->_nextLink)
         {
-            if (pBinding->_pListener == &listener) return pBinding; 
+            if (pLink->_type == BindingType::Listener && ((EventBinding*)pLink)->_pListener == &listener) return pLink; 
         }
 
-        pBinding = new EventBinding(listener);
+        pBinding = _bindingPool.Allocate<IEventListener&>(listener);
+
+        if (pBinding == NULL) return NULL;
     }
 
     Attach(*pBinding);
@@ -51,12 +101,34 @@ IEventBinding* EventSource::Attach(EVENT_LISTENER pfListener, StaticEventBinding
 {
     if (pBinding == NULL)
     {
-        for (auto pBinding = (StaticEventBinding*)_firstBinding; pBinding != NULL; pBinding = (StaticEventBinding*)pBinding->_nextLink)
+        for (auto pLink = _firstBinding; pLink != NULL; pLink = pLink->_nextLink)
+        {
+            if (pLink->_type == BindingType::Function && ((StaticEventBinding*)pLink)->_pfEventListener == pfListener) return pLink; 
+        }
+
+        pBinding = _staticBindingPool.Allocate(pfListener);
+
+        if (pBinding == NULL) return NULL;
+    }
+
+    Attach(*pBinding);
+
+    return pBinding;
+}
+
+
+IEventBinding* EventSource::Attach(IBatchEventListener& listener, BatchEventBinding* pBinding)
+{
+    if (pBinding == NULL)
+    {
+        for (auto pLink = _firstBinding; pLink != NULL; pLink = pLink->_nextLink)
         {
-            if (pBinding->_pfEventListener == pfListener) return pBinding; 
+            if (pLink->_type == BindingType::Batch && ((BatchEventBinding*)pLink)->_pListener == &listener) return pLink; 
         }
 
-        pBinding = new StaticEventBinding(pfListener);
+        pBinding = _batchBindingPool.Allocate<IBatchEventListener&>(listener);
+
+        if (pBinding == NULL) return NULL;
     }
 
     Attach(*pBinding);
@@ -65,74 +137,180 @@ IEventBinding* EventSource::Attach(EVENT_LISTENER pfListener, StaticEventBinding
 }
 
 
+//******************************************************************************
+// Add an event binding that is subscribed to a set of event IDs
+//******************************************************************************
+void EventSource::Subscribe(IEventBinding& binding, EVENT_ID eventID, EVENT_ID eventMask)
+{
+    // The binding chain depends on the subscription, so unlink the binding before
+    // changing it
+    binding.Unlink();
+
+    binding._eventID = eventID & eventMask;
+    binding._eventMask = eventMask;
+
+    Attach(binding);
+}
+
+
+IEventBinding* EventSource::Subscribe(IEventListener& listener, EVENT_ID eventID, EVENT_ID eventMask, EventBinding* pBinding)
+{
+    if (pBinding == NULL) pBinding = _bindingPool.Allocate<IEventListener&>(listener);
+
+    if (pBinding == NULL) return NULL;
+
+    Subscribe(*pBinding, eventID, eventMask);
+
+    return pBinding;
+}
+
+
+IEventBinding* EventSource::Subscribe(EVENT_LISTENER pfListener, EVENT_ID eventID, EVENT_ID eventMask, StaticEventBinding* pBinding)
+{
+    if (pBinding == NULL) pBinding = _staticBindingPool.Allocate(pfListener);
+
+    if (pBinding == NULL) return NULL;
+
+    Subscribe(*pBinding, eventID, eventMask);
+
+    return pBinding;
+}
+
+
 //******************************************************************************
 // Removes an event binding from this EventSource's list of bindings
 //******************************************************************************
 void EventSource::Detach(IEventBinding& binding)
 {
-    IEventBinding*& nextLink = _firstBinding;
+    if (binding._source != this) return;
+
+    binding.Unlink();
+    TRACE(Logger(_classname_, this) << F("Detach: binding=") << _HEX(PTR(&binding)) << endl);
+
+    _FreeBinding(binding);
+}
+
+
+//******************************************************************************
+// Returns a binding that was created by Attach() or Subscribe() to its pool
+//******************************************************************************
+void EventSource::_FreeBinding(IEventBinding& binding)
+{
+    if (_bindingPool.Owns(&binding)) _bindingPool.Free(static_cast<EventBinding*>(&binding));
+    else if (_staticBindingPool.Owns(&binding)) _staticBindingPool.Free(static_cast<StaticEventBinding*>(&binding));
+    else if (_batchBindingPool.Owns(&binding)) _batchBindingPool.Free(static_cast<BatchEventBinding*>(&binding));
+}
+
+
+//******************************************************************************
+// Determines if the source has any listeners attached
+//******************************************************************************
+bool EventSource::HasListeners()
+{
+    if (_firstBinding != NULL) return true;
 
-    do 
+#if EVENT_BINDING_BUCKETS > 0
+    for (uint8_t i = 0; i < EVENT_BINDING_BUCKETS; i++)
     {
-        if (nextLink == &binding)
-        {
-            binding.Unlink(nextLink);
-            break;
-        }
+        if (_bucket[i] != NULL) return true;
+    }
+#endif
 
-        nextLink = nextLink->_nextLink;
-    } 
-    while (nextLink != NULL);
+    return false;
+}
 
-    // // Special case if the binding is the head of the linked-list
-    // if (_firstBinding == &binding)
-    // {
-        // binding.Unlink(_firstBinding);
-    // }
-    // else
-    // {
-        // // Otherwise, we have to walk the linked list to find the binding
-        // for (auto pBinding = _firstBinding; pBinding != NULL; pBinding = pBinding->_nextLink)
-        // {
-            // if (pBinding->_nextLink == &binding)
-            // {
-                // binding.Unlink(pBinding->_nextLink);
-                // break;
-            // }
-        // }
-    // }
 
-    // // Make sure the binding's 'next' pointer is empty to prevent future issues
-    // binding._nextLink = NULL;
+//******************************************************************************
+// Returns the head of the binding list that a binding belongs in
+//******************************************************************************
+IEventBinding*& EventSource::_BindingList(IEventBinding& binding)
+{
+#if EVENT_BINDING_BUCKETS > 0
+    if (binding._eventMask == EventMask::Exact) return _bucket[BUCKET_OF(binding._eventID)];
+#endif
+
+    return _firstBinding;
 }
 
 
 //******************************************************************************
 // Queues an event with the given event ID and data.
 //******************************************************************************
-void EventSource::QueueEvent(EVENT_ID eventID, variant_t eventData)
+bool EventSource::QueueEvent(EVENT_ID eventID, variant_t eventData, uint8_t priority)
 {
-    TRACE(Logger(_classname_, this) << F("QueueEvent: eventID=") << _HEX(eventID) << endl);
-
-    Event event(eventID, eventData); { event.Source = this; }
+    Event event(eventID, eventData);
 
-    EventDispatcher::Queue(event);
+    return QueueEvent(event, priority);
 }
 
 
 //******************************************************************************
 // Queues an event with the given event ID and data.
 //******************************************************************************
-void EventSource::QueueEvent(Event& event)
+bool EventSource::QueueEvent(Event& event, uint8_t priority)
 {
     TRACE(Logger(_classname_, this) << F("QueueEvent: eventID=") << _HEX(event.EventID) << endl);
 
     event.Source = this;
 
-    EventDispatcher::Queue(event);
+    bool isQueued = GetEventLoop().Queue(event, priority);
+
+#if EVENT_SOURCE_STATISTICS
+    // The counters are only approximate if the source queues events from both
+    // an ISR and the main loop
+    if (isQueued) { if (_queuedCount != 0xFFFF) _queuedCount++; }
+    else          { if (_droppedCount != 0xFFFF) _droppedCount++; }
+#endif
+
+    return isQueued;
+}
+
+
+//******************************************************************************
+// Returns the number of events the source could queue right now
+//******************************************************************************
+uint16_t EventSource::QueueCapacity(EVENT_ID eventID, uint8_t priority)
+{
+    uint16_t capacity = GetEventLoop().FreeCapacity(eventID, priority);
+
+#if EVENT_SOURCE_QUOTAS
+    if (_quota != 0)
+    {
+        uint16_t pending = _pending.Load();
+        uint16_t credits = (pending < _quota) ? _quota - pending : 0;
+
+        if (credits < capacity) capacity = credits;
+    }
+#endif
+
+    return capacity;
+}
+
+
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+//******************************************************************************
+// Queues an event after a delay
+//******************************************************************************
+EVENT_TIMER EventSource::QueueEventAfter(Event& event, uint32_t delayMicros, uint8_t priority)
+{
+    event.Source = this;
+
+    return GetEventLoop().QueueEventAfter(event, delayMicros, priority);
 }
 
 
+//******************************************************************************
+// Queues an event periodically
+//******************************************************************************
+EVENT_TIMER EventSource::QueueEventEvery(Event& event, uint32_t periodMicros, uint8_t priority)
+{
+    event.Source = this;
+
+    return GetEventLoop().QueueEventEvery(event, periodMicros, priority);
+}
+#endif
+
+
 //******************************************************************************
 // Creates and dispatches an event with the given event ID and data to the
 // attached listeners.
@@ -151,10 +329,96 @@ void EventSource::DispatchEvent(EVENT_ID eventID, variant_t eventData)
 void EventSource::DispatchEvent(Event& event)
 {
     TRACE(Logger(_classname_, this) << F("DispatchEvent: eventID=") << _HEX(event.EventID) << endl);
+    EVENT_TRACE(EventTraceType::Dispatch, this, event.EventID, 0);
+    EVENT_CAPTURE_EVENT(this, event);
+
+    _DispatchEvent(_firstBinding, event);
+
+#if EVENT_BINDING_BUCKETS > 0
+    _DispatchEvent(_bucket[BUCKET_OF(event.EventID)], event);
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+    EventLoop& loop = GetEventLoop();
+
+    _DispatchEvent(loop._anyTopic, event);
+    _DispatchEvent(loop._TopicBucket(event.EventID), event);
+#endif
+
+    EVENT_TRACE(EventTraceType::DispatchEnd, this, event.EventID, 0);
+}
+
 
-    for (IEventBinding* pBinding = _firstBinding; pBinding != NULL; pBinding = pBinding->_nextLink)
+inline void EventSource::_DispatchEvent(IEventBinding* pBinding, Event& event)
+{
+    // The next link is fetched before the event is dispatched, so that a listener
+    // can detach its own binding while handling the event.
+    for (IEventBinding* pNext; pBinding != NULL; pBinding = pNext)
     {
-        pBinding->DispatchEvent(event);
+        pNext = pBinding->_nextLink;
+
+        if (pBinding->Accepts(event.EventID)) pBinding->DispatchEvent(event);
     }
 }
 
+
+#if EVENT_BATCH_SIZE > 0
+//******************************************************************************
+// Dispatches a group of this source's events to the attached listeners. Each 
+// binding receives the whole group at once, so batch listeners get it in a 
+// single call.
+//******************************************************************************
+void EventSource::_DispatchEvents(Event* pEvents, uint8_t count)
+{
+    TRACE(Logger(_classname_, this) << F("DispatchEvents: count=") << count << endl);
+    EVENT_TRACE(EventTraceType::Dispatch, this, pEvents[0].EventID, count);
+
+#if EVENT_CAPTURE
+    for (uint8_t i = 0; i < count; i++) EVENT_CAPTURE_EVENT(this, pEvents[i]);
+#endif
+
+    // The next link is fetched before the events are dispatched, so that a listener
+    // can detach its own binding while handling them.
+    for (IEventBinding *pBinding = _firstBinding, *pNext; pBinding != NULL; pBinding = pNext)
+    {
+        pNext = pBinding->_nextLink;
+        pBinding->DispatchEvents(pEvents, count);
+    }
+
+#if EVENT_BINDING_BUCKETS > 0
+    // The bindings in the buckets are subscribed to exact event IDs, so they each
+    // only accept the events of their own ID in the group
+    for (uint8_t bucket = 0; bucket < EVENT_BINDING_BUCKETS; bucket++)
+    {
+        for (IEventBinding *pBinding = _bucket[bucket], *pNext; pBinding != NULL; pBinding = pNext)
+        {
+            pNext = pBinding->_nextLink;
+            pBinding->DispatchEvents(pEvents, count);
+        }
+    }
+#endif
+
+#if EVENT_TOPIC_BUCKETS > 0
+    // The topic subscriptions of the source's loop get the group too; the events
+    // of a group don't necessarily share an EventSourceID, so every chain is walked
+    EventLoop& loop = GetEventLoop();
+
+    for (IEventBinding *pBinding = loop._anyTopic, *pNext; pBinding != NULL; pBinding = pNext)
+    {
+        pNext = pBinding->_nextLink;
+        pBinding->DispatchEvents(pEvents, count);
+    }
+
+    for (uint8_t bucket = 0; bucket < EVENT_TOPIC_BUCKETS; bucket++)
+    {
+        for (IEventBinding *pBinding = loop._topic[bucket], *pNext; pBinding != NULL; pBinding = pNext)
+        {
+            pNext = pBinding->_nextLink;
+            pBinding->DispatchEvents(pEvents, count);
+        }
+    }
+#endif
+
+    EVENT_TRACE(EventTraceType::DispatchEnd, this, pEvents[0].EventID, count);
+}
+#endif
@@ -2,17 +2,23 @@
 #define _EventSource_h_
 
 #include <inttypes.h>
-#include <RTL_Stdlib.h>
+#include <RTL_StdLib.h>
 #include <RTL_Variant.h>
 
+#include "EventFrameworkConfig.h"
 #include "IPollable.h"
 #include "EventCodes.h"
 #include "IEventListener.h"
+#include "ObjectPool.h"
+#include "EventCapture.h"
+#include "EventTimer.h"
+#include "EventAtomic.h"
 
 
 class IEventBinding;
 class EventBinding;
 class StaticEventBinding;
+class BatchEventBinding;
 
 
 /*******************************************************************************
@@ -34,35 +40,56 @@ the head of this linked list. The Attach() and Detach() methods manage this link
 list. To allow them to do that, IEventBinding declares EventSource as a friend class
 so it can access the private _nextEventListener member.
 
-EventSources attach themselves to the global EventDispatcher object when they are
-created. The EventDispatcher then calls the Poll() method of each EventSource
-whenever its DispatchEvents() method is called. To ensure events are detected
-and dispatched as expeditiously as possible, the EventDispatcher::DispatchEvents()
-method should be called on every iteration in a sketch's loop() method.
+Bindings attached with Subscribe() only receive the events they subscribe to.
+Bindings that subscribe to an exact event ID are kept in EVENT_BINDING_BUCKETS 
+lists indexed by a hash of the event ID, and all other bindings in the _firstBinding
+list. Dispatching an event only walks the _firstBinding list and the one bucket 
+list for the event's ID, so listeners that aren't interested in an event are mostly
+never touched. The event is then dispatched to the matching topic subscriptions of
+the source's event loop (see EventLoop::Subscribe()).
+
+EventSources add themselves to the default event loop (EventDispatcher::Default())
+when they are created, and can be moved to another loop with EventLoop::Add(). 
+The loop then calls the Poll() method of each EventSource whenever its 
+DispatchEvents() method is called. To ensure events are detected and dispatched
+as expeditiously as possible, the loop's DispatchEvents() method should be called
+on every iteration in a sketch's loop() method.
 *******************************************************************************/
 class EventSource : public IPollable    // Size = 6 + Base(2) = 8
 {
     DECLARE_CLASSNAME;
     
-    friend class EventDispatcher;
+    friend class EventLoop;
     friend class IEventBinding;
+    friend class EventReplay;
+    friend class ParallelDispatcher;
 
     /***************************************************************************
     Constructors
     ***************************************************************************/
 
     /// The constructor is protected to enforce abstract base class semantics
-    protected: EventSource() { _id = "?"; };
+    protected: EventSource();
 
     /***************************************************************************
     Public Methods
     ***************************************************************************/
-    /// Adds an event binging to this source
+    /// Adds an event binging to this source.
+    /// The overloads that take a listener create a binding for it (unless one is
+    /// given) from a fixed-size pool, and return NULL if the pool is exhausted.
     public: void Attach(IEventBinding& binding);
     public: IEventBinding* Attach(IEventListener& listener, EventBinding* pBinding=NULL);
     public: IEventBinding* Attach(EVENT_LISTENER pfListener, StaticEventBinding* pBinding=NULL);
+    public: IEventBinding* Attach(IBatchEventListener& listener, BatchEventBinding* pBinding=NULL);
 
-    /// Removes an event binging from this source
+    /// Adds an event binding to this source that only receives the events whose
+    /// IDs match 'eventID' in the bits selected by 'eventMask'.
+    public: void Subscribe(IEventBinding& binding, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact);
+    public: IEventBinding* Subscribe(IEventListener& listener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, EventBinding* pBinding=NULL);
+    public: IEventBinding* Subscribe(EVENT_LISTENER pfListener, EVENT_ID eventID, EVENT_ID eventMask=EventMask::Exact, StaticEventBinding* pBinding=NULL);
+
+    /// Removes an event binging from this source. A binding that was created by 
+    /// Attach() or Subscribe() is returned to its pool.
     public: void Detach(IEventBinding& binding);
 
     /// Polls this source for events.
@@ -71,7 +98,31 @@ class EventSource : public IPollable    // Size = 6 + Base(2) = 8
     public: virtual void Poll() { };
 
     /// Determines if the source has any listeners attached
-    public: bool HasListeners() { return _firstBinding != NULL; };
+    public: bool HasListeners();
+
+    /// Turns coalescing on or off for the events queued by this source. While a
+    /// coalesced event is pending, queueing another event with the same event ID
+    /// replaces the pending event's data rather than queueing a new event. The
+    /// pending event keeps the priority lane of the first event.
+    public: void SetCoalescing(bool isCoalescing=true) { _isCoalescing = isCoalescing; };
+
+#if EVENT_SOURCE_QUOTAS
+    /// Limits the number of this source's events that can be waiting in its event
+    /// loop's queue at once (0 for no limit), so that a burst from this source 
+    /// can't take the whole queue. Coalesced events don't count against the quota.
+    public: void SetQueueQuota(uint8_t quota) { _quota = quota; };
+
+    /// The number of this source's events that are waiting in the queue
+    public: uint16_t PendingCount() const { return _pending.Load(); };
+#endif
+
+#if EVENT_SOURCE_STATISTICS
+    /// The number of events this source has queued (saturates at 65535)
+    public: uint16_t QueuedCount() const { return _queuedCount; };
+
+    /// The number of events this source could not queue because the queue was full (saturates at 65535)
+    public: uint16_t DroppedCount() const { return _droppedCount; };
+#endif
 
     /// Returns a new unique event ID with every call. Used to assign dynamic event IDs
     public: static EVENT_ID GenerateEventID() { return _nextEventID++; }
@@ -80,11 +131,32 @@ class EventSource : public IPollable    // Size = 6 + Base(2) = 8
     Protected Methods
     ***************************************************************************/
 
-    /// Creates and queues an event with the given event ID and data.
-    protected: void QueueEvent(EVENT_ID eventID, variant_t eventData=0L);
-
-    /// Queues an event
-    protected: void QueueEvent(Event& pEvent);
+    /// Creates and queues an event with the given event ID, data and priority.
+    /// Returns false if the event could not be queued (i.e., the queue is full or
+    /// the source has used up its quota).
+    protected: bool QueueEvent(EVENT_ID eventID, variant_t eventData=0L, uint8_t priority=EventPriority::Default);
+
+    /// Queues an event with the given priority.
+    /// Returns false if the event could not be queued (i.e., the queue is full or
+    /// the source has used up its quota).
+    protected: bool QueueEvent(Event& pEvent, uint8_t priority=EventPriority::Default);
+
+    /// Returns the number of events with the given event ID and priority that this
+    /// source could queue right now, so that a source can skip the work of producing
+    /// an event that would be rejected. Not a reservation: an ISR or another source 
+    /// can take the capacity first.
+    protected: uint16_t QueueCapacity(EVENT_ID eventID, uint8_t priority=EventPriority::Default);
+
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+    /// Queues an event once, 'delayMicros' microseconds from now. Returns a handle
+    /// for EventDispatcher::CancelTimer(), or 0 if the timer pool is exhausted.
+    protected: EVENT_TIMER QueueEventAfter(Event& event, uint32_t delayMicros, uint8_t priority=EventPriority::Default);
+
+    /// Queues an event every 'periodMicros' microseconds until the timer is cancelled.
+    /// Returns a handle for EventDispatcher::CancelTimer(), or 0 if the timer pool
+    /// is exhausted.
+    protected: EVENT_TIMER QueueEventEvery(Event& event, uint32_t periodMicros, uint8_t priority=EventPriority::Default);
+#endif
 
     /// Creates and dispatches an event with the given event ID and data to the
     /// attached listeners.
@@ -93,15 +165,61 @@ class EventSource : public IPollable    // Size = 6 + Base(2) = 8
     /// Dispatches an event to the attached listeners.
     protected: void DispatchEvent(Event& pEvent);
 
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+
+    /// Returns the head of the binding list that a binding belongs in
+    private: IEventBinding*& _BindingList(IEventBinding& binding);
+
+    /// Dispatches an event to the bindings in a list that accept it
+    private: static inline void _DispatchEvent(IEventBinding* pBinding, Event& event);
+
+    /// Returns a binding that was created by Attach() or Subscribe() to its pool
+    private: static void _FreeBinding(IEventBinding& binding);
+
+#if EVENT_BATCH_SIZE > 0
+    /// Dispatches a group of this source's events, in order, to the attached listeners
+    private: void _DispatchEvents(Event* pEvents, uint8_t count);
+#endif
+
     /***************************************************************************
     Internal state
     ***************************************************************************/
 
-    /// The first binding in the binding chain (linked list)
+    /// The first binding in the binding chain (linked list) of bindings that are
+    /// not subscribed to an exact event ID
     private: IEventBinding* _firstBinding;          // size = 2
 
+#if EVENT_BINDING_BUCKETS > 0
+    /// The binding chains of bindings subscribed to an exact event ID, indexed by
+    /// a hash of the event ID
+    private: IEventBinding* _bucket[EVENT_BINDING_BUCKETS];    // size = 2*EVENT_BINDING_BUCKETS
+#endif
+
+    /// Indicates if this source's queued events are coalesced
+    private: bool _isCoalescing;                    // size = 1
+
+#if EVENT_SOURCE_STATISTICS
+    /// The number of events queued and dropped by this source
+    private: uint16_t _queuedCount;                 // size = 2
+    private: uint16_t _droppedCount;                // size = 2
+#endif
+
+#if EVENT_SOURCE_QUOTAS
+    /// The most events the source may have in the queue (0 for no limit), and the 
+    /// number it has there (updated by the event loop)
+    private: uint8_t _quota;                        // size = 1
+    private: AtomicValue<uint16_t> _pending;        // size = 2
+#endif
+
     /// The next event ID
     private: static EVENT_ID _nextEventID;          // size = 2
+
+    /// The pools of bindings created for listeners
+    private: static ObjectPool<EventBinding, EVENT_BINDING_POOL_SIZE> _bindingPool;
+    private: static ObjectPool<StaticEventBinding, EVENT_STATIC_BINDING_POOL_SIZE> _staticBindingPool;
+    private: static ObjectPool<BatchEventBinding, EVENT_BATCH_BINDING_POOL_SIZE> _batchBindingPool;
 };
 
 #endif
@@ -0,0 +1,68 @@
+#ifndef _EventTimer_h_
+#define _EventTimer_h_
+
+#include <Arduino.h>
+#include "EventFrameworkConfig.h"
+#include "Event.h"
+#include "TimerWheel.h"
+#include "ObjectPool.h"
+
+
+/// A handle to an event timer (see EventLoop::QueueEventAfter()). 0 is never a
+/// valid handle.
+typedef uint16_t EVENT_TIMER;
+
+
+class EventLoop;
+
+
+/*******************************************************************************
+An event that is queued after a delay or periodically.
+
+Event timers are created by EventLoop::QueueEventAfter() and QueueEventEvery()
+(or the EventSource and EventDispatcher methods of the same names) from a fixed
+pool of EVENT_TIMER_POOL_SIZE timers, and are scheduled on their event loop's
+timer wheel - the same wheel that schedules polling. Hundreds of timers therefore
+cost one deadline check per DispatchEvents() instead of a poll each.
+
+A timer is referred to by an EVENT_TIMER handle rather than a pointer. A one-shot
+timer returns to the pool when it fires, and its handle then becomes stale;
+cancelling a stale handle does nothing, even after the timer has been reused.
+
+The pool is shared by all event loops. A timer is only ever taken off its loop's
+wheel by that loop: CancelTimer() marks the timer as cancelled and hands it to 
+its loop, which frees it on its next DispatchEvents(), so a timer can be 
+cancelled from the thread of another loop.
+*******************************************************************************/
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+
+class EventTimer : private TimerWheelNode       // size = 26
+{
+    friend class EventLoop;
+    friend class ObjectPool<EventTimer, EVENT_TIMER_POOL_SIZE>;
+
+    private: EventTimer(EventLoop* pLoop) : _loop(pLoop), _period(0), _priority(0), _isCancelled(false), _nextCancelled(NULL) {};
+
+    /// The event that is queued when the timer fires
+    private: Event _event;                      // size = 8
+
+    /// The event loop the event is queued to
+    private: EventLoop* _loop;                  // size = 2
+
+    /// The period in timer wheel ticks (0 for a one-shot timer)
+    private: uint32_t _period;                  // size = 4
+
+    /// The priority the event is queued with
+    private: uint8_t _priority;                 // size = 1
+
+    /// Set by CancelTimer(); the timer no longer fires and waits for its loop to
+    /// free it
+    private: volatile bool _isCancelled;        // size = 1
+
+    /// The next timer in the loop's list of cancelled timers
+    private: EventTimer* _nextCancelled;        // size = 2
+};
+
+#endif
+
+#endif
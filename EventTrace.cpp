@@ -0,0 +1,100 @@
+/*******************************************************************************
+A fixed-size binary trace recorder. See EventTrace.h for details.
+*******************************************************************************/
+#include <Arduino.h>
+#include "EventTrace.h"
+
+#if EVENT_TRACE_SIZE > 0
+
+static_assert((EVENT_TRACE_SIZE & (EVENT_TRACE_SIZE - 1)) == 0 && EVENT_TRACE_SIZE <= 32768, "EVENT_TRACE_SIZE must be a power of 2 (up to 32768)");
+
+
+EventTraceRecord EventTrace::_records[EVENT_TRACE_SIZE];
+AtomicValue<uint16_t> EventTrace::_next;
+volatile bool EventTrace::_isFull = false;
+
+
+//******************************************************************************
+// The number of records in the trace buffer
+//******************************************************************************
+uint16_t EventTrace::Count()
+{
+    return _isFull ? EVENT_TRACE_SIZE : (_next.Load() & (EVENT_TRACE_SIZE - 1));
+}
+
+
+//******************************************************************************
+// Discards all records
+//******************************************************************************
+void EventTrace::Clear()
+{
+    noInterrupts();
+    // ATOMIC BLOCK BEGIN
+    _next.Store(0);
+    _isFull = false;
+    // ATOMIC BLOCK END
+    interrupts();
+}
+
+
+//******************************************************************************
+// Copies the most recent records, oldest first, into a buffer
+//******************************************************************************
+uint16_t EventTrace::Snapshot(EventTraceRecord* buffer, uint16_t size)
+{
+    uint16_t count = Count();
+    uint16_t next = _next.Load();
+
+    if (size > count) size = count;
+
+    for (uint16_t i = 0; i < size; i++)
+    {
+        buffer[i] = _records[(uint16_t)(next - size + i) & (EVENT_TRACE_SIZE - 1)];
+    }
+
+    return size;
+}
+
+
+//******************************************************************************
+// Writes the trace buffer in the binary dump format
+//******************************************************************************
+void EventTrace::Dump(TRACE_WRITER writer)
+{
+    uint16_t count = Count();
+    uint16_t next = _next.Load();
+    uint8_t buffer[12];
+
+    buffer[0] = 'E';
+    buffer[1] = 'V';
+    buffer[2] = 'T';
+    buffer[3] = 'R';
+    buffer[4] = 1;
+    buffer[5] = sizeof(buffer);
+    buffer[6] = (uint8_t)count;
+    buffer[7] = (uint8_t)(count >> 8);
+
+    writer(buffer, 8);
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const EventTraceRecord& record = _records[(uint16_t)(next - count + i) & (EVENT_TRACE_SIZE - 1)];
+
+        buffer[0]  = (uint8_t)record.Time;
+        buffer[1]  = (uint8_t)(record.Time >> 8);
+        buffer[2]  = (uint8_t)(record.Time >> 16);
+        buffer[3]  = (uint8_t)(record.Time >> 24);
+        buffer[4]  = (uint8_t)record.Source;
+        buffer[5]  = (uint8_t)(record.Source >> 8);
+        buffer[6]  = (uint8_t)(record.Source >> 16);
+        buffer[7]  = (uint8_t)(record.Source >> 24);
+        buffer[8]  = (uint8_t)record.EventID;
+        buffer[9]  = (uint8_t)(record.EventID >> 8);
+        buffer[10] = record.Type;
+        buffer[11] = record.Info;
+
+        writer(buffer, sizeof(buffer));
+    }
+}
+
+#endif
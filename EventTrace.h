@@ -0,0 +1,128 @@
+#ifndef _EventTrace_h_
+#define _EventTrace_h_
+
+#include <Arduino.h>
+#include "EventFrameworkConfig.h"
+#include "EventAtomic.h"
+#include "Event.h"
+
+
+/*******************************************************************************
+The kinds of records written by the trace recorder.
+*******************************************************************************/
+class EventTraceType
+{
+    public: enum
+    {
+        Enqueue     = 1,    // An event was queued (Info = priority lane)
+        Drop        = 2,    // An event could not be queued (Info = priority lane)
+        Dequeue     = 3,    // An event was taken from the queue (Info = priority lane)
+        Dispatch    = 4,    // A source started dispatching an event to its listeners
+        DispatchEnd = 5,    // A source finished dispatching an event to its listeners
+        PollStart   = 6,    // An object's Poll() method was called (Source = the object)
+        PollEnd     = 7,    // An object's Poll() method returned (Source = the object)
+    };
+};
+
+
+/*******************************************************************************
+A trace record.
+
+Source is a handle that identifies the event source (or the polled object); it is
+the low 32 bits of the object's address, which is enough to tell the objects in a
+trace apart.
+*******************************************************************************/
+struct EventTraceRecord     // size = 12
+{
+    uint32_t Time;          // micros() when the record was written
+    uint32_t Source;        // The source (or polled object) handle
+    EVENT_ID EventID;       // The event ID (0 for poll records)
+    uint8_t  Type;          // See EventTraceType
+    uint8_t  Info;          // Type-specific information
+};
+
+
+/// Function that receives the bytes of a trace dump or an event capture (e.g.,
+/// writes them to Serial)
+typedef void (*TRACE_WRITER)(const uint8_t* data, uint16_t length);
+
+
+#if EVENT_TRACE_SIZE > 0
+
+#define EVENT_TRACE(type, source, eventID, info) EventTrace::Record((type), (source), (eventID), (info))
+
+/*******************************************************************************
+A fixed-size binary trace recorder.
+
+The recorder keeps the last EVENT_TRACE_SIZE records in a ring buffer. Writing a
+record is an atomic increment plus a few stores - there is no formatting and no
+I/O - so it can be left on in production without noticeably changing the timing
+of the application. This makes it suitable for finding latency spikes that the
+text logging enabled by TRACE hides (or causes).
+
+The framework records events being queued, dropped, de-queued and dispatched, and
+objects being polled. Records can be written from ISRs.
+
+The records are written out with Dump() in a compact little-endian format that
+host/TraceDump.cpp turns into a timeline:
+
+    Header (8 bytes):  'E' 'V' 'T' 'R', version (1), record size (12), record count (2)
+    Records (12 bytes each, oldest first): Time (4), Source (4), EventID (2), Type (1), Info (1)
+
+Dump() and Snapshot() read the ring buffer while it may still be written to; to
+get a consistent dump call them when no events are being queued or dispatched
+(e.g., from the main loop when nothing else is running).
+*******************************************************************************/
+class EventTrace
+{
+    /// Writes a trace record
+    public: static inline void Record(uint8_t type, const void* source, EVENT_ID eventID=0, uint8_t info=0);
+
+    /// The number of records in the trace buffer
+    public: static uint16_t Count();
+
+    /// Discards all records
+    public: static void Clear();
+
+    /// Copies up to 'size' of the most recent records, oldest first, into buffer.
+    /// Returns the number of records copied.
+    public: static uint16_t Snapshot(EventTraceRecord* buffer, uint16_t size);
+
+    /// Writes the trace buffer, oldest record first, in the binary dump format
+    public: static void Dump(TRACE_WRITER writer);
+
+    /// The trace records
+    private: static EventTraceRecord _records[EVENT_TRACE_SIZE];
+
+    /// The number of records written (wraps around)
+    private: static AtomicValue<uint16_t> _next;
+
+    /// Indicates if the trace buffer has wrapped around
+    private: static volatile bool _isFull;
+};
+
+
+//******************************************************************************
+// Writes a trace record
+//******************************************************************************
+inline void EventTrace::Record(uint8_t type, const void* source, EVENT_ID eventID, uint8_t info)
+{
+    uint16_t index = _next.FetchAdd(1) & (EVENT_TRACE_SIZE - 1);
+    EventTraceRecord& record = _records[index];
+
+    record.Time = micros();
+    record.Source = (uint32_t)(uintptr_t)source;
+    record.EventID = eventID;
+    record.Type = type;
+    record.Info = info;
+
+    if (index == EVENT_TRACE_SIZE - 1) _isFull = true;
+}
+
+#else
+
+#define EVENT_TRACE(type, source, eventID, info)
+
+#endif
+
+#endif
@@ -41,4 +41,36 @@ class IEventListener
     //**************************************************************************
 };
 
+
+/*******************************************************************************
+Defines an interface for an event listener that receives events in batches. This
+is an abstract base class that must be extended by a derived class.
+
+A batch listener receives a contiguous span of events per call, so high-rate
+consumers (e.g., loggers and filters) can process them in a tight loop instead 
+of paying for a pair of virtual calls per event. When EVENT_BATCH_SIZE is set,
+EventLoop::DispatchEvents() de-queues events in batches and groups them by
+source, so a batch listener receives all of a source's events in the batch at 
+once (in the order they were queued). Events dispatched any other way arrive in
+spans of one event.
+
+A batch listener is attached with EventSource::Attach(IBatchEventListener&) or 
+through a BatchEventBinding.
+*******************************************************************************/
+class IBatchEventListener
+{
+    //**************************************************************************
+    // Constructors
+    //**************************************************************************
+
+    /// The constructor is protected to enforce abstract base class semantics
+    protected: IBatchEventListener() {};
+
+    //**************************************************************************
+    // Protected methods
+    //**************************************************************************
+
+    public: virtual void OnEvents(const Event* pEvents, size_t count) = 0;
+};
+
 #endif
@@ -5,11 +5,48 @@
 IPollable::IPollable(bool autoAdd) 
 { 
     _id = "?";
+    _nextObject = nullptr;
+    _prevObject = nullptr;
+    _isRoundRobin = false;
+    _pollWeight = 1;
+    _nextReady = nullptr;
+    _isReady = false;
+    _loop = &EventDispatcher::Default();
 
-    if (autoAdd) EventDispatcher::Add(*this); 
+#if EVENT_SCHEDULED_POLLING
+    _pollPeriod = 0;
+#endif
+
+    if (autoAdd) _loop->Add(*this); 
 }
 
 
 void IPollable::Poll()
 {
 }
+
+
+void IPollable::PollWhenReady()
+{
+    _loop->PollWhenReady(*this);
+}
+
+
+void IPollable::SetReady()
+{
+    _loop->SetReady(*this);
+}
+
+
+#if EVENT_SCHEDULED_POLLING
+void IPollable::SetPollPeriod(uint32_t periodMicros)
+{
+    _loop->SetPollPeriod(*this, periodMicros);
+}
+
+
+void IPollable::PollAfter(uint32_t delayMicros)
+{
+    _loop->PollAfter(*this, delayMicros);
+}
+#endif
@@ -2,27 +2,55 @@
 #define _IPollable_h_
 
 #include<Arduino.h>
+#include "EventFrameworkConfig.h"
+#include "TimerWheel.h"
 
 typedef void (*POLL_FUNCTION)();
 
+class EventLoop;
+
 
 /*******************************************************************************
-Defines an interface for an object than can be polled by the EventDispatcher. 
+Defines an interface for an object than can be polled by an EventLoop. 
 This is an abstract interface base class that must be implemented by a derived class.
 
-The EventDispatcher class calls the Poll() method of all IPollable objects that
-have been registered with it. The most common kind of IPollable object is an
-EventSource, but other kinds of objects that don't source events - but still need 
-to be polled, can implement this interface as well. Most IPollable objects 
-automatically register with the EventDispatcher either in their constructor(s)
-or in an initialization method.
+An EventLoop calls the Poll() method of all IPollable objects that have been added
+to it. The most common kind of IPollable object is an EventSource, but other kinds
+of objects that don't source events - but still need to be polled, can implement
+this interface as well. Most IPollable objects automatically add themselves to the
+default loop (EventDispatcher::Default()) either in their constructor(s) or in an
+initialization method.
+
+By default, the loop polls objects round-robin, one per call to DispatchEvents(). With weighted round-robin polling, an object with a poll weight
+of N (see SetPollWeight()) keeps its turn for N consecutive calls, so it is polled
+N times as often as an object with the default weight of 1. The polls come in a
+burst: while an object has its turn no other round-robin object is polled, so an
+object with a weight of 255 holds up the rest of the rotation for 255 calls.
+
+An object that only needs to be polled at a certain rate can call SetPollPeriod()
+instead, and an object that knows when it next needs to be polled can call 
+PollAfter() (typically from its own Poll() method). Such objects are taken out of
+the round-robin rotation and are only polled when they are due.
+
+Objects whose Poll() method usually finds nothing to do (e.g., because the hardware
+has no news) can call PollWhenReady() to leave the rotation altogether. They are
+then only polled after they - or an ISR acting for them - call SetReady(). Any 
+object can call SetReady() to be polled on the next call to DispatchEvents().
+
+Each object belongs to one EventLoop: the default loop, unless it has been added
+to another loop with EventLoop::Add(). The object's poll scheduling methods act
+on that loop, and an EventSource queues its events to it.
 
 A class that implements this interface must provide an implementation for the
 Poll() method to handle events dispatched to it.
 *******************************************************************************/
-class IPollable     // Size = 4
+#if EVENT_SCHEDULED_POLLING
+class IPollable : private TimerWheelNode    // Size = 26
+#else
+class IPollable     // Size = 13
+#endif
 {
-    friend class EventDispatcher;
+    friend class EventLoop;
 
     protected: IPollable(bool autoAdd=true);
     
@@ -30,11 +58,58 @@ class IPollable     // Size = 4
 
     public: const char* ID() { return _id; };
 
+    /// The event loop the object belongs to
+    public: EventLoop& GetEventLoop() const { return *_loop; };
+
+#if EVENT_SCHEDULED_POLLING
+    /// Polls this object every 'periodMicros' microseconds instead of round-robin.
+    /// A period of 0 returns the object to round-robin polling.
+    public: void SetPollPeriod(uint32_t periodMicros);
+
+    /// Polls this object once, 'delayMicros' microseconds from now, instead of 
+    /// round-robin. After that poll the object is not polled again until it calls
+    /// PollAfter() or SetPollPeriod() again.
+    public: void PollAfter(uint32_t delayMicros);
+
+    /// The poll period in timer wheel ticks (0 if the object is not polled periodically)
+    private: uint32_t _pollPeriod;          // size = 4
+#endif
+
+    /// Polls this object only after SetReady() is called, instead of round-robin.
+    /// Add() (or SetPollPeriod()/PollAfter()) puts the object back on a schedule.
+    public: void PollWhenReady();
+
+    /// Marks the object as ready, so it is polled on the next call to DispatchEvents().
+    /// Can be called from an ISR.
+    public: void SetReady();
+
+    /// Sets the number of polls the object gets on each turn of the round-robin
+    /// rotation (1 to 255; 1 is the default). The polls are made on consecutive
+    /// calls to DispatchEvents(), while the other objects in the rotation wait.
+    public: void SetPollWeight(uint8_t weight) { _pollWeight = (weight != 0) ? weight : 1; };
+
+    /// The number of polls the object gets on each turn of the round-robin rotation
+    public: uint8_t GetPollWeight() const { return _pollWeight; };
+
     /// The object ID string
-    protected: char* _id;                   // size = 2
+    protected: const char* _id;             // size = 2
 
-    /// The next object in the polling chain (linked list)
+    /// The event loop the object belongs to
+    private: EventLoop* _loop;              // size = 2
+
+    /// The next and previous objects in the polling chain (doubly-linked list)
     private: IPollable* _nextObject;        // Size = 2
+    private: IPollable* _prevObject;        // Size = 2
+
+    /// Indicates if the object is in its loop's round-robin polling list
+    private: bool _isRoundRobin;            // size = 1
+
+    /// The number of polls the object gets on each turn of the rotation
+    private: uint8_t _pollWeight;           // size = 1
+
+    /// The next object in the ready list, and whether the object is in the list
+    private: IPollable* _nextReady;         // size = 2
+    private: bool _isReady;                 // size = 1
 };
 
 
@@ -0,0 +1,232 @@
+#ifndef _LockFreeEventQueue_h_
+#define _LockFreeEventQueue_h_
+
+#include "Event.h"
+#include "EventAtomic.h"
+#include "EventQueue.h"
+
+
+/// Selects the smallest position type for a lock-free queue of a given size.
+/// Lock-free positions wrap around, so they need one more bit of headroom than
+/// plain indexes do.
+template<bool SMALL> struct _LockFreeQueueIndex        { typedef uint16_t type; typedef int16_t signed_type; };
+template<>           struct _LockFreeQueueIndex<true>  { typedef uint8_t  type; typedef int8_t  signed_type; };
+
+
+/*******************************************************************************
+A fixed-capacity, lock-free, single-producer/single-consumer event queue.
+
+Exactly one context may queue events and exactly one context may de-queue them.
+This fits programs where events are queued only from loop() code (i.e., by
+EventSource::Poll() methods) or only from a single interrupt. The queue never
+disables interrupts.
+
+The head and tail are free-running positions; the slot index is the position
+masked by the (power of two) capacity. The producer publishes a slot by advancing
+the tail with release semantics after the event has been written, and the consumer
+frees it by advancing the head after the event has been read.
+
+When the queue is full, new events are rejected (QueueOverflowPolicy::RejectNewest).
+*******************************************************************************/
+template<uint16_t SIZE>
+class SpscEventQueue
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SpscEventQueue size must be a power of two");
+    static_assert(SIZE <= 16384, "SpscEventQueue size is too large");
+
+    public: typedef typename _LockFreeQueueIndex<(SIZE <= 64)>::type index_t;
+
+    private: static const index_t MASK = SIZE - 1;
+
+    public: SpscEventQueue() : _head(0), _tail(0) {};
+
+    /// The capacity of the queue
+    public: static index_t Capacity() { return SIZE; };
+
+    /// The number of events in the queue
+    public: index_t Count() const { return (index_t)(_tail.Load() - _head.Load()); };
+
+    /// Determines if the queue is empty
+    public: bool IsEmpty() const { return Count() == 0; };
+
+    /// Adds an event to the tail of the queue.
+    /// Returns false if the queue is full.
+    public: bool Queue(const Event& event)
+    {
+        index_t tail = _tail.LoadRelaxed();
+
+        if ((index_t)(tail - _head.Load()) == SIZE) return false;
+
+        _queue[tail & MASK] = event;
+        _tail.Store(tail + 1);
+
+        return true;
+    };
+
+    /// Adds an event to the tail of the queue (see EventQueue::Queue()). The queue
+    /// never drops a queued event, so 'isDropped' is always false.
+    public: bool Queue(const Event& event, Event&, bool& isDropped) { isDropped = false; return Queue(event); };
+
+    /// Removes the event at the head of the queue.
+    /// Returns false if the queue is empty.
+    public: bool Dequeue(Event& event)
+    {
+        index_t head = _head.LoadRelaxed();
+
+        if (head == _tail.Load()) return false;
+
+        event = _queue[head & MASK];
+        _head.Store(head + 1);
+
+        return true;
+    };
+
+    private: Event _queue[SIZE];
+    private: AtomicValue<index_t> _head;
+    private: AtomicValue<index_t> _tail;
+};
+
+
+/*******************************************************************************
+A fixed-capacity, lock-free, multi-producer/single-consumer event queue.
+
+Any number of contexts - loop() code and any number of interrupts - may queue
+events concurrently, but only one context (normally DispatchEvents()) may de-queue
+them. The queue never disables interrupts on platforms that have a native
+compare-and-swap; see EventAtomic.h for the platforms that don't.
+
+This is a bounded queue in the style of D. Vyukov's MPMC queue. Each slot carries
+a sequence number that tells producers and the consumer whose turn it is:
+
+- seq == pos      The slot is free for the producer that claims position 'pos'.
+- seq == pos + 1  The slot holds the event for position 'pos' and is ready to be
+                  de-queued.
+
+A producer claims a position by advancing the tail with compare-and-swap, writes
+the event and then publishes it by bumping the slot sequence. Because the claim
+and the publish are separate steps, an interrupted producer may briefly leave a
+claimed-but-unpublished slot at the head; the consumer then simply stops and picks
+that event (and any behind it) up on a later pass.
+
+When the queue is full, new events are rejected (QueueOverflowPolicy::RejectNewest).
+*******************************************************************************/
+template<uint16_t SIZE>
+class MpscEventQueue
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "MpscEventQueue size must be a power of two");
+    static_assert(SIZE <= 16384, "MpscEventQueue size is too large");
+
+    public: typedef typename _LockFreeQueueIndex<(SIZE <= 64)>::type index_t;
+    private: typedef typename _LockFreeQueueIndex<(SIZE <= 64)>::signed_type diff_t;
+
+    private: static const index_t MASK = SIZE - 1;
+
+    private: struct Slot
+    {
+        AtomicValue<index_t> Sequence;
+        Event Value;
+    };
+
+    public: MpscEventQueue() : _head(0), _tail(0)
+    {
+        for (index_t i = 0; i < SIZE; i++) _queue[i].Sequence.StoreRelaxed(i);
+    };
+
+    /// The capacity of the queue
+    public: static index_t Capacity() { return SIZE; };
+
+    /// The number of events in the queue (including events that are still being
+    /// written by a producer)
+    public: index_t Count() const { return (index_t)(_tail.Load() - _head.LoadRelaxed()); };
+
+    /// Determines if the queue is empty
+    public: bool IsEmpty() const { return Count() == 0; };
+
+    /// Adds an event to the tail of the queue.
+    /// Returns false if the queue is full.
+    public: bool Queue(const Event& event)
+    {
+        index_t pos = _tail.LoadRelaxed();
+        Slot* pSlot;
+
+        for (;;)
+        {
+            pSlot = &_queue[pos & MASK];
+
+            auto diff = (diff_t)(index_t)(pSlot->Sequence.Load() - pos);
+
+            if (diff == 0)
+            {
+                if (_tail.CompareExchange(pos, pos + 1)) break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _tail.LoadRelaxed();
+            }
+        }
+
+        pSlot->Value = event;
+        pSlot->Sequence.Store(pos + 1);
+
+        return true;
+    };
+
+    /// Adds an event to the tail of the queue (see EventQueue::Queue()). The queue
+    /// never drops a queued event, so 'isDropped' is always false.
+    public: bool Queue(const Event& event, Event&, bool& isDropped) { isDropped = false; return Queue(event); };
+
+    /// Removes the event at the head of the queue.
+    /// Returns false if the queue is empty or the event at the head has not been
+    /// published yet.
+    public: bool Dequeue(Event& event)
+    {
+        index_t pos = _head.LoadRelaxed();
+        Slot& slot = _queue[pos & MASK];
+
+        if (slot.Sequence.Load() != (index_t)(pos + 1)) return false;
+
+        event = slot.Value;
+        slot.Sequence.Store(pos + SIZE);
+        _head.Store(pos + 1);
+
+        return true;
+    };
+
+    private: Slot _queue[SIZE];
+    private: AtomicValue<index_t> _head;
+    private: AtomicValue<index_t> _tail;
+};
+
+
+
+/*******************************************************************************
+Maps an EventQueueModel (and the other queue settings) to a queue type.
+Lock-free queues only support the RejectNewest overflow policy.
+*******************************************************************************/
+template<uint8_t MODEL, uint16_t SIZE, uint8_t POLICY>
+struct SelectEventQueue
+{
+    typedef EventQueue<SIZE, POLICY> type;
+};
+
+template<uint16_t SIZE, uint8_t POLICY>
+struct SelectEventQueue<EventQueueModel::SingleProducer, SIZE, POLICY>
+{
+    static_assert(POLICY == QueueOverflowPolicy::RejectNewest, "Lock-free event queues only support QueueOverflowPolicy::RejectNewest; use EventQueueModel::Guarded");
+
+    typedef SpscEventQueue<SIZE> type;
+};
+
+template<uint16_t SIZE, uint8_t POLICY>
+struct SelectEventQueue<EventQueueModel::MultiProducer, SIZE, POLICY>
+{
+    static_assert(POLICY == QueueOverflowPolicy::RejectNewest, "Lock-free event queues only support QueueOverflowPolicy::RejectNewest; use EventQueueModel::Guarded");
+
+    typedef MpscEventQueue<SIZE> type;
+};
+
+#endif
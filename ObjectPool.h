@@ -0,0 +1,143 @@
+#ifndef _ObjectPool_h_
+#define _ObjectPool_h_
+
+#include <Arduino.h>
+
+#if EVENTFRAMEWORK_HOST || !defined(__AVR__)
+#include <new>
+#else
+#include <new.h>
+#endif
+
+
+/*******************************************************************************
+A fixed-capacity pool of objects of type T.
+
+The storage for all SIZE objects is reserved statically, so the pool never touches
+the heap. Blocks that have never been used are handed out in order, up to a 
+high-water index, and blocks that have been freed are chained together in a free
+list threaded through the blocks themselves, which makes both Allocate() and Free()
+O(1). Allocate() returns NULL when the pool is exhausted.
+
+The constructor is constexpr and only zeroes the pool's state, so a pool that is
+a global or a static member is initialized before any code runs. A global object
+whose constructor allocates from a pool (e.g., by attaching a listener) can't run
+before the pool is ready, whatever the order in which the globals are constructed.
+
+The framework uses pools for the objects it creates on behalf of the caller 
+(e.g., the EventBinding created by EventSource::Attach(IEventListener&)), so that
+memory use is deterministic and there is no heap fragmentation.
+*******************************************************************************/
+template<typename T, uint16_t SIZE>
+class ObjectPool
+{
+    /// A pool block. While the block is free it holds the free list link.
+    private: union Block
+    {
+        constexpr Block() : NextFree(NULL) {};
+
+        Block* NextFree;
+        alignas(T) uint8_t Storage[sizeof(T)];
+    };
+
+    /***************************************************************************
+    Constructors
+    ***************************************************************************/
+    public: constexpr ObjectPool() : _blocks(), _isAllocated(), _firstFree(NULL), _highWater(0), _count(0) {};
+
+    /***************************************************************************
+    Public Methods
+    ***************************************************************************/
+
+    /// The capacity of the pool
+    public: static uint16_t Capacity() { return SIZE; };
+
+    /// The number of allocated objects
+    public: uint16_t Count() const { return _count; };
+
+    /// Allocates an object constructed with the given argument.
+    /// Returns NULL if the pool is exhausted.
+    public: template<typename A> T* Allocate(A arg)
+    {
+        Block* pBlock = _firstFree;
+
+        if (pBlock != NULL) _firstFree = pBlock->NextFree;
+        else if (_highWater < SIZE) pBlock = &_blocks[_highWater++];
+        else return NULL;
+
+        _SetAllocated(pBlock - _blocks, true);
+        _count++;
+
+        return new (pBlock->Storage) T(arg);
+    };
+
+    /// Destroys an object and returns it to the pool.
+    /// Does nothing if the object was not allocated from this pool, or has already
+    /// been returned to it.
+    public: void Free(T* pObject)
+    {
+        if (!Owns(pObject) || !_IsAllocated(IndexOf(pObject))) return;
+
+        pObject->~T();
+
+        Block* pBlock = reinterpret_cast<Block*>(pObject);
+
+        _SetAllocated(pBlock - _blocks, false);
+
+        pBlock->NextFree = _firstFree;
+        _firstFree = pBlock;
+        _count--;
+    };
+
+    /// Returns the index of an object's block in the pool
+    public: uint16_t IndexOf(const T* pObject) const
+    {
+        return (uint16_t)(reinterpret_cast<const Block*>(pObject) - _blocks);
+    };
+
+    /// Returns the object in the block with the given index. The block must be
+    /// allocated.
+    public: T* At(uint16_t index)
+    {
+        return reinterpret_cast<T*>(_blocks[index].Storage);
+    };
+
+    /// Determines if an object was allocated from this pool
+    public: bool Owns(const void* pObject) const
+    {
+        return SIZE > 0 && pObject >= (const void*)&_blocks[0] && pObject < (const void*)&_blocks[SIZE];
+    };
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+    private: bool _IsAllocated(uint16_t index) const
+    {
+        return (_isAllocated[index >> 3] & (1 << (index & 7))) != 0;
+    };
+
+    private: void _SetAllocated(uint16_t index, bool isAllocated)
+    {
+        if (isAllocated) _isAllocated[index >> 3] |= (uint8_t)(1 << (index & 7));
+        else _isAllocated[index >> 3] &= (uint8_t)~(1 << (index & 7));
+    };
+
+    /***************************************************************************
+    Internal state
+    ***************************************************************************/
+    private: Block _blocks[SIZE > 0 ? SIZE : 1];
+
+    /// One bit per block, set while the block is allocated
+    private: uint8_t _isAllocated[SIZE > 0 ? (SIZE + 7) / 8 : 1];
+
+    /// The free list of blocks that have been allocated and freed again
+    private: Block* _firstFree;
+
+    /// The number of blocks that have ever been allocated. The blocks from here
+    /// on have never been used.
+    private: uint16_t _highWater;
+
+    private: uint16_t _count;
+};
+
+#endif
@@ -1,15 +1,17 @@
 #ifndef _EventFramework_h_
 #define _EventFramework_h_
 
-#include <RTL_Stdlib.h>
+#include <RTL_StdLib.h>
 #include <RTL_Variant.h>
 
 #include "IPollable.h"
 #include "Event.h"
+#include "EventPayload.h"
 #include "EventCodes.h"
 #include "IEventListener.h"
 #include "EventSource.h"
 #include "EventBinding.h"
+#include "EventHandlerTable.h"
 #include "EventDispatcher.h"
 
 #endif
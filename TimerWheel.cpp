@@ -0,0 +1,188 @@
+/*******************************************************************************
+A hierarchical timing wheel. See TimerWheel.h for details.
+*******************************************************************************/
+#include <Arduino.h>
+#include "TimerWheel.h"
+
+
+static_assert(EVENT_WHEEL_LEVELS >= 1 && EVENT_WHEEL_SLOT_BITS >= 1 && EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOT_BITS <= 30, "Invalid timer wheel geometry");
+
+
+TimerWheel::TimerWheel() : _now(0), _count(0)
+{
+    memset(_slots, 0, sizeof(_slots));
+}
+
+
+//******************************************************************************
+// Schedules a node
+//******************************************************************************
+void TimerWheel::Schedule(TimerWheelNode& node, uint32_t dueTick)
+{
+    if (node.IsScheduled()) _Unlink(node);
+    else _count++;
+
+    // The slot for the current tick has already been processed, so the earliest
+    // a node can become due is the next tick.
+    if ((int32_t)(dueTick - _now) <= 0) dueTick = _now + 1;
+
+    node._dueTick = dueTick;
+    _Place(node);
+}
+
+
+//******************************************************************************
+// Cancels a scheduled node
+//******************************************************************************
+void TimerWheel::Cancel(TimerWheelNode& node)
+{
+    if (!node.IsScheduled()) return;
+
+    _Unlink(node);
+    _count--;
+}
+
+
+//******************************************************************************
+// Advances the wheel, expiring the nodes that become due
+//******************************************************************************
+void TimerWheel::Advance(uint32_t tick, TIMER_CALLBACK callback)
+{
+    while ((int32_t)(tick - _now) > 0)
+    {
+        // Nothing is scheduled, so just jump ahead
+        if (_count == 0)
+        {
+            _now = tick;
+            break;
+        }
+
+        _now++;
+
+        // Cascade the higher levels, from the top down, whenever the current tick 
+        // crosses one of their slot boundaries.
+        for (uint8_t level = LEVELS - 1; level > 0; level--)
+        {
+            uint8_t shift = level * SLOT_BITS;
+
+            if ((_now & ((1UL << shift) - 1)) != 0) continue;
+
+            // Detach the slot first, since nodes parked in the top level can be
+            // placed right back into the slot being cascaded.
+            TimerWheelNode*& slot = _slots[level][(_now >> shift) & MASK];
+            TimerWheelNode*  head = slot;
+
+            if (head == NULL) continue;
+
+            slot = NULL;
+            head->_wheelPrev = &head;
+
+            while (head != NULL)
+            {
+                TimerWheelNode& node = *head;
+
+                _Unlink(node);
+                _Place(node);
+            }
+        }
+
+        // Detach the due nodes onto a local list before expiring them so that
+        // callbacks can safely reschedule or cancel nodes.
+        TimerWheelNode*& slot = _slots[0][_now & MASK];
+        TimerWheelNode*  due = slot;
+
+        if (due == NULL) continue;
+
+        slot = NULL;
+        due->_wheelPrev = &due;
+
+        while (due != NULL)
+        {
+            TimerWheelNode& node = *due;
+
+            _Unlink(node);
+            _count--;
+
+            (*callback)(&node);
+        }
+    }
+}
+
+
+//******************************************************************************
+// Gets the earliest tick at which a node can become due
+//******************************************************************************
+bool TimerWheel::NextDue(uint32_t& tick) const
+{
+    if (_count == 0) return false;
+
+    bool isFound = false;
+
+    // On level 0 a slot holds the nodes due on exactly one tick. On the higher
+    // levels the nodes in a slot become due no earlier than when the slot is
+    // cascaded. The current slot of a level comes around again last, since it
+    // can only hold nodes parked in the top level.
+    for (uint8_t level = 0; level < LEVELS; level++)
+    {
+        uint8_t shift = level * SLOT_BITS;
+
+        for (uint8_t i = 1; i <= SLOTS; i++)
+        {
+            uint32_t slotTick = ((_now >> shift) + i) << shift;
+
+            if (_slots[level][(slotTick >> shift) & MASK] == NULL) continue;
+
+            if (!isFound || (int32_t)(slotTick - tick) < 0) tick = slotTick;
+
+            isFound = true;
+            break;
+        }
+    }
+
+    return isFound;
+}
+
+
+//******************************************************************************
+// Places a node in the slot that matches its due tick
+//******************************************************************************
+void TimerWheel::_Place(TimerWheelNode& node)
+{
+    int32_t delta = (int32_t)(node._dueTick - _now);
+
+    // A node that cascades down exactly on its due tick goes in the current slot,
+    // which is processed right after cascading.
+    if (delta <= 0)
+    {
+        _Link(_slots[0][_now & MASK], node);
+        return;
+    }
+
+    uint8_t level = 0;
+
+    while (level < LEVELS - 1 && (uint32_t)delta >= (1UL << ((level + 1) * SLOT_BITS))) level++;
+
+    _Link(_slots[level][(node._dueTick >> (level * SLOT_BITS)) & MASK], node);
+}
+
+
+void TimerWheel::_Link(TimerWheelNode*& head, TimerWheelNode& node)
+{
+    node._wheelNext = head;
+    node._wheelPrev = &head;
+
+    if (head != NULL) head->_wheelPrev = &node._wheelNext;
+
+    head = &node;
+}
+
+
+void TimerWheel::_Unlink(TimerWheelNode& node)
+{
+    *node._wheelPrev = node._wheelNext;
+
+    if (node._wheelNext != NULL) node._wheelNext->_wheelPrev = node._wheelPrev;
+
+    node._wheelNext = NULL;
+    node._wheelPrev = NULL;
+}
@@ -0,0 +1,125 @@
+#ifndef _TimerWheel_h_
+#define _TimerWheel_h_
+
+#include <Arduino.h>
+#include "EventFrameworkConfig.h"
+
+
+class TimerWheel;
+
+
+/*******************************************************************************
+An object that can be scheduled on a TimerWheel. This is a base class that is
+extended by the classes whose instances need to be scheduled (e.g., IPollable).
+
+The scheduling links are intrusive, so scheduling and cancelling never allocate
+memory. The nodes in a timer wheel slot form a doubly-linked list in which each
+node points back at the pointer that points to it (the slot head or the previous
+node's 'next' pointer), so a node can be unlinked in O(1) without knowing which 
+slot it is in.
+*******************************************************************************/
+class TimerWheelNode        // size = 8
+{
+    friend class TimerWheel;
+
+    protected: TimerWheelNode() : _wheelNext(NULL), _wheelPrev(NULL), _dueTick(0) {};
+
+    /// Determines if the node is currently scheduled on a timer wheel
+    public: bool IsScheduled() const { return _wheelPrev != NULL; };
+
+    /// The tick the node is (or was last) scheduled for
+    public: uint32_t DueTick() const { return _dueTick; };
+
+    /// The next node in the timer wheel slot
+    private: TimerWheelNode* _wheelNext;        // size = 2
+
+    /// The pointer that points to this node
+    private: TimerWheelNode** _wheelPrev;       // size = 2
+
+    /// The tick the node is due
+    private: uint32_t _dueTick;                 // size = 4
+};
+
+
+typedef void (*TIMER_CALLBACK)(TimerWheelNode* pNode);
+
+
+/*******************************************************************************
+A hierarchical timing wheel.
+
+Time is measured in ticks. The wheel has EVENT_WHEEL_LEVELS levels of 2^EVENT_WHEEL_SLOT_BITS
+slots each. Level 0 has one slot per tick, level 1 one slot per 2^EVENT_WHEEL_SLOT_BITS
+ticks, and so on. A node is placed on the lowest level whose span covers its due
+tick. Whenever the wheel's time crosses a level boundary, the nodes in the matching
+slot of the next higher level are cascaded down to the lower levels. Nodes whose
+due tick is farther out than the whole wheel spans are parked in the top level
+and re-placed each time they are cascaded.
+
+Scheduling and cancelling are O(1); advancing the wheel costs O(1) per tick plus
+O(1) per node that becomes due or is cascaded.
+*******************************************************************************/
+class TimerWheel
+{
+    public: static const uint8_t LEVELS    = EVENT_WHEEL_LEVELS;
+    public: static const uint8_t SLOT_BITS = EVENT_WHEEL_SLOT_BITS;
+    public: static const uint8_t SLOTS     = 1 << SLOT_BITS;
+
+    private: static const uint8_t MASK     = SLOTS - 1;
+
+    /***************************************************************************
+    Constructors
+    ***************************************************************************/
+    public: TimerWheel();
+
+    /***************************************************************************
+    Public Methods
+    ***************************************************************************/
+
+    /// The wheel's current tick
+    public: uint32_t Now() const { return _now; };
+
+    /// The number of scheduled nodes
+    public: uint16_t Count() const { return _count; };
+
+    /// Schedules a node to be due at the given tick. A node that is already
+    /// scheduled is rescheduled. A tick that is not in the future schedules the
+    /// node for the next tick.
+    public: void Schedule(TimerWheelNode& node, uint32_t dueTick);
+
+    /// Cancels a scheduled node. Does nothing if the node is not scheduled.
+    public: void Cancel(TimerWheelNode& node);
+
+    /// Advances the wheel to the given tick and invokes the callback for each node
+    /// that becomes due. Nodes are unscheduled before the callback is invoked, so
+    /// the callback is free to reschedule them (or to cancel any other node).
+    public: void Advance(uint32_t tick, TIMER_CALLBACK callback);
+
+    /// Gets the earliest tick at which a node can become due. Returns false if no
+    /// node is scheduled. The tick is exact for nodes due within the next SLOTS ticks;
+    /// for nodes farther out it is the tick at which their slot is cascaded, which 
+    /// is never later than the node's due tick.
+    public: bool NextDue(uint32_t& tick) const;
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+    private: void _Place(TimerWheelNode& node);
+
+    private: static void _Link(TimerWheelNode*& head, TimerWheelNode& node);
+
+    private: static void _Unlink(TimerWheelNode& node);
+
+    /***************************************************************************
+    Internal state
+    ***************************************************************************/
+    /// The slots, each the head of a list of nodes
+    private: TimerWheelNode* _slots[LEVELS][SLOTS];     // size = 2*LEVELS*SLOTS
+
+    /// The current tick
+    private: uint32_t _now;                             // size = 4
+
+    /// The number of scheduled nodes
+    private: uint16_t _count;                           // size = 2
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _Host_Arduino_h_
+#define _Host_Arduino_h_
+
+/*******************************************************************************
+Host (Linux) stand-in for the Arduino core header.
+
+Only the subset of the Arduino API that the event framework uses is provided.
+Timing and interrupt control are implemented by HostPlatform.
+*******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "HostPlatform.h"
+
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define F(s) (s)
+#define PROGMEM
+
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void noInterrupts();
+void interrupts();
+
+#endif
@@ -0,0 +1,140 @@
+/*******************************************************************************
+Host benchmark for EventDispatcher::DispatchEvents().
+
+Sets up a number of event sources that each queue an event when polled, plus a
+simulated interrupt that queues events asynchronously, and then measures how long
+DispatchEvents() takes. Intended to be run under perf or valgrind, e.g.:
+
+    perf record ./DispatchBench 1000000
+    valgrind --tool=callgrind ./DispatchBench 100000
+
+Usage: DispatchBench [iterations] [sources] [listeners-per-source] [trace-file]
+
+If the library is built with EVENT_TRACE_SIZE > 0 the trace buffer is written to
+trace-file at the end of the run; view it with TraceDump.
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <RTL_EventFramework.h>
+
+
+static const EVENT_ID BenchEvent = EventSourceID::CustomEvent | EventCode::Update;
+static const EVENT_ID IsrEvent   = EventSourceID::CustomEvent | EventCode::Detect;
+
+
+class BenchSource : public EventSource
+{
+    public: BenchSource() { _id = "BenchSource"; };
+
+    public: virtual void Poll() { QueueEvent(BenchEvent, (int32_t)++_count); };
+
+    public: void RaiseFromIsr() { QueueEvent(IsrEvent, (int32_t)++_count); };
+
+    private: int32_t _count = 0;
+};
+
+
+class BenchListener : public IEventListener
+{
+    public: virtual void OnEvent(const Event* pEvent) { Received++; Checksum += pEvent->Data.Long; };
+
+    public: static uint64_t Received;
+    public: static uint64_t Checksum;
+};
+
+uint64_t BenchListener::Received = 0;
+uint64_t BenchListener::Checksum = 0;
+
+
+static BenchSource* s_pIsrSource;
+
+#if EVENT_TRACE_SIZE > 0
+static FILE* s_pTraceFile;
+
+static void WriteTrace(const uint8_t* data, uint16_t length)
+{
+    fwrite(data, 1, length, s_pTraceFile);
+}
+#endif
+
+static void BenchIsr()
+{
+    s_pIsrSource->RaiseFromIsr();
+}
+
+
+int main(int argc, char* argv[])
+{
+    long iterations = (argc > 1) ? atol(argv[1]) : 1000000;
+    int  sources    = (argc > 2) ? atoi(argv[2]) : 8;
+    int  listeners  = (argc > 3) ? atoi(argv[3]) : 2;
+
+    std::vector<BenchSource*>   sourceList;
+    std::vector<BenchListener*> listenerList;
+
+    for (int i = 0; i < sources; i++)
+    {
+        auto pSource = new BenchSource();
+
+        for (int j = 0; j < listeners; j++)
+        {
+            auto pListener = new BenchListener();
+
+            // The bench supplies its own bindings, since the framework's binding
+            // pool is sized for a microcontroller.
+            pSource->Attach(*pListener, new EventBinding(*pListener));
+            listenerList.push_back(pListener);
+        }
+
+        sourceList.push_back(pSource);
+    }
+
+    s_pIsrSource = sourceList[0];
+
+    auto start = std::chrono::steady_clock::now();
+    
+    for (long i = 0; i < iterations; i++)
+    {
+        if ((i & 3) == 0) HostPlatform::RaiseInterrupt(BenchIsr);
+
+        EventDispatcher::DispatchEvents();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    printf("iterations:       %ld\n", iterations);
+    printf("sources:          %d\n", sources);
+    printf("listeners/source: %d\n", listeners);
+    printf("events received:  %llu\n", (unsigned long long)BenchListener::Received);
+    printf("checksum:         %llu\n", (unsigned long long)BenchListener::Checksum);
+    printf("ns/DispatchEvents %.1f\n", (double)nanos / iterations);
+
+#if EVENT_STATISTICS
+    EventStatistics stats;
+
+    EventDispatcher::GetStatistics(stats);
+
+    printf("dispatched:       %lu\n", (unsigned long)stats.Dispatched);
+    printf("dropped:          %lu\n", (unsigned long)stats.Dropped);
+    printf("coalesced:        %lu\n", (unsigned long)stats.Coalesced);
+    printf("queue high-water: %u/%u\n", stats.HighWater, stats.Capacity);
+#if EVENT_STATISTICS >= 2
+    printf("max latency (us): %lu\n", (unsigned long)stats.MaxLatency);
+#endif
+#endif
+
+#if EVENT_TRACE_SIZE > 0
+    if (argc > 4 && (s_pTraceFile = fopen(argv[4], "wb")) != nullptr)
+    {
+        EventTrace::Dump(WriteTrace);
+        fclose(s_pTraceFile);
+        printf("trace records:    %u (%s)\n", EventTrace::Count(), argv[4]);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+Replays a captured event stream into a listener graph on the host. See
+EventReplay.h for details.
+*******************************************************************************/
+#include <stdio.h>
+
+#include "EventReplay.h"
+#include "HostPlatform.h"
+
+
+static uint32_t ReadU32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t ReadU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+
+//******************************************************************************
+// Loads a capture file
+//******************************************************************************
+bool EventReplay::Load(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (file == nullptr) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t length;
+
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + length);
+
+    fclose(file);
+
+    return Load(data.data(), data.size());
+}
+
+
+//******************************************************************************
+// Loads a capture from memory
+//******************************************************************************
+bool EventReplay::Load(const uint8_t* data, size_t length)
+{
+    _sources.clear();
+    _events.clear();
+
+    if (length < 8 || data[0] != 'E' || data[1] != 'V' || data[2] != 'C' || data[3] != 'P' || data[4] != 1) return false;
+
+    for (size_t i = 8; i < length; )
+    {
+        if (data[i] == 1 && i + 3 <= length && i + 3 + data[i + 2] <= length)
+        {
+            // Source record. Indexes are assigned in order, so the index is implied.
+            CapturedSource source;
+
+            source.ID.assign((const char*)data + i + 3, data[i + 2]);
+            source.pSource = nullptr;
+            _sources.push_back(source);
+            i += 3 + data[i + 2];
+        }
+        else if (data[i] == 2 && i + 12 <= length)
+        {
+            CapturedEvent event;
+
+            event.Source  = data[i + 1];
+            event.Time    = ReadU32(data + i + 2);
+            event.EventID = ReadU16(data + i + 6);
+            event.Data    = ReadU32(data + i + 8);
+            _events.push_back(event);
+            i += 12;
+        }
+        else
+        {
+            // Unknown record or truncated capture. Keep what was read so far.
+            return !_events.empty();
+        }
+    }
+
+    return true;
+}
+
+
+//******************************************************************************
+// Maps the first unmapped captured source with the given ID to a host source
+//******************************************************************************
+bool EventReplay::Map(const char* id, EventSource& source)
+{
+    for (CapturedSource& captured : _sources)
+    {
+        if (captured.pSource == nullptr && captured.ID == id)
+        {
+            captured.pSource = &source;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//******************************************************************************
+// Replays the capture
+//******************************************************************************
+size_t EventReplay::Run(uint8_t mode, double speed)
+{
+    IHostClock& clock = HostPlatform::Clock();
+    uint64_t start = clock.Micros();
+    uint64_t offset = 0;
+    size_t count = 0;
+
+    if (mode == ReplayMode::RealTime || speed <= 0) speed = 1.0;
+
+    for (size_t i = 0; i < _events.size(); i++)
+    {
+        const CapturedEvent& captured = _events[i];
+
+        // The captured timestamps wrap around, so the offset of each event from the
+        // start of the capture is accumulated from the differences between events
+        if (i > 0) offset += (uint32_t)(captured.Time - _events[i - 1].Time);
+
+        if (captured.Source >= _sources.size() || _sources[captured.Source].pSource == nullptr) continue;
+
+        if (mode != ReplayMode::Max)
+        {
+            uint64_t due = start + (uint64_t)(offset / speed);
+            uint64_t now = clock.Micros();
+
+            if (due > now) clock.Delay(due - now);
+        }
+
+        EventSource& source = *_sources[captured.Source].pSource;
+        Event event(captured.EventID, captured.Data);
+
+        event.Source = &source;
+        source.DispatchEvent(event);
+        count++;
+    }
+
+    _elapsedMicros = clock.Micros() - start;
+
+    return count;
+}
@@ -0,0 +1,94 @@
+#ifndef _Host_EventReplay_h_
+#define _Host_EventReplay_h_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "EventSource.h"
+
+
+/*******************************************************************************
+The pacing of an event replay.
+*******************************************************************************/
+class ReplayMode
+{
+    public: enum
+    {
+        RealTime    = 0,    // Events are dispatched with the time between them they were captured with
+        Accelerated = 1,    // The time between events is divided by the replay speed
+        Max         = 2,    // Events are dispatched back-to-back as fast as possible
+    };
+};
+
+
+/*******************************************************************************
+Replays a captured event stream (see EventCapture) into a listener graph on the
+host.
+
+The listener graph is rebuilt on the host with the same event sources (or stand-ins
+for them) and listeners as on the device. The captured sources are then mapped to
+the host sources with Map(), and Run() dispatches the captured events to the mapped
+sources' listeners exactly as EventSource::DispatchEvent() did on the device.
+Events of sources that aren't mapped are skipped.
+
+The events are dispatched directly to the sources' listeners; the EventDispatcher
+is not involved, and sources are not polled. Events that listeners queue in response
+are already part of the capture (it contains every dispatched event), so they
+should not be dispatched again.
+
+Real-time and accelerated replays wait on the HostPlatform clock, so with a
+SimulatedClock a replay runs as fast as possible but listeners still see the
+captured timing.
+*******************************************************************************/
+class EventReplay
+{
+    /// Loads a capture. Returns false if the file can't be read or isn't a capture.
+    public: bool Load(const char* path);
+
+    /// Loads a capture from memory
+    public: bool Load(const uint8_t* data, size_t length);
+
+    /// The number of events in the capture
+    public: size_t Count() const { return _events.size(); };
+
+    /// The number of sources in the capture
+    public: uint8_t SourceCount() const { return (uint8_t)_sources.size(); };
+
+    /// The ID of a captured source
+    public: const char* SourceID(uint8_t index) const { return _sources[index].ID.c_str(); };
+
+    /// Maps a captured source to a host source
+    public: void Map(uint8_t index, EventSource& source) { _sources[index].pSource = &source; };
+
+    /// Maps the first unmapped captured source with the given ID to a host source.
+    /// Returns false if there is no such captured source. Sources that share an ID
+    /// are mapped in the order they first dispatched an event in the capture.
+    public: bool Map(const char* id, EventSource& source);
+
+    /// Replays the capture. Returns the number of events dispatched.
+    public: size_t Run(uint8_t mode=ReplayMode::Max, double speed=1.0);
+
+    /// The time the last Run() took, in microseconds (of the HostPlatform clock)
+    public: uint64_t ElapsedMicros() const { return _elapsedMicros; };
+
+    private: struct CapturedSource
+    {
+        std::string ID;
+        EventSource* pSource;
+    };
+
+    private: struct CapturedEvent
+    {
+        uint32_t Time;
+        uint8_t Source;
+        EVENT_ID EventID;
+        uint32_t Data;
+    };
+
+    private: std::vector<CapturedSource> _sources;
+    private: std::vector<CapturedEvent> _events;
+    private: uint64_t _elapsedMicros = 0;
+};
+
+#endif
@@ -0,0 +1,273 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "HostPlatform.h"
+#include "Arduino.h"
+
+
+/*******************************************************************************
+Host platform layer. See HostPlatform.h for details.
+*******************************************************************************/
+
+static SystemClock   s_systemClock;
+static IHostClock*   s_pClock = &s_systemClock;
+
+/// The gate that is held while interrupts are disabled
+static std::mutex    s_gate;
+
+/// ISRs raised while interrupts were disabled, waiting to be delivered
+static std::mutex                s_pendingLock;
+static std::deque<ISR_FUNCTION>  s_pending;
+
+/// Sleep() waits on s_wake while it has released the gate. s_wakePending is set
+/// by Wake() and consumed by Sleep(), so a Wake() that comes before Sleep() isn't lost.
+static std::condition_variable  s_wake;
+static std::atomic<bool>        s_wakePending(false);
+static std::atomic<uint16_t>    s_sleepers(0);
+
+/// Per-thread interrupt state
+static thread_local bool    t_interruptsOff = false;
+static thread_local uint8_t t_isrDepth = 0;
+
+
+//******************************************************************************
+// SystemClock
+//******************************************************************************
+static uint64_t SteadyMicros()
+{
+    using namespace std::chrono;
+
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+SystemClock::SystemClock() : _origin(SteadyMicros())
+{
+}
+
+
+uint64_t SystemClock::Micros()
+{
+    return SteadyMicros() - _origin;
+}
+
+
+void SystemClock::Delay(uint64_t micros)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(micros));
+}
+
+
+//******************************************************************************
+// Clock
+//******************************************************************************
+void HostPlatform::SetClock(IHostClock* pClock)
+{
+    s_pClock = (pClock != NULL) ? pClock : &s_systemClock;
+}
+
+
+IHostClock& HostPlatform::Clock()
+{
+    return *s_pClock;
+}
+
+
+//******************************************************************************
+// Critical sections
+//******************************************************************************
+void HostPlatform::DisableInterrupts()
+{
+    if (t_interruptsOff) return;
+
+    s_gate.lock();
+    t_interruptsOff = true;
+}
+
+
+void HostPlatform::EnableInterrupts()
+{
+    // Interrupts stay off for the duration of an ISR
+    if (!t_interruptsOff || t_isrDepth > 0) return;
+
+    t_interruptsOff = false;
+    s_gate.unlock();
+
+    _DeliverPending();
+}
+
+
+bool HostPlatform::InterruptsDisabled()
+{
+    return t_interruptsOff;
+}
+
+
+bool HostPlatform::InInterrupt()
+{
+    return t_isrDepth > 0;
+}
+
+
+//******************************************************************************
+// Interrupt injection
+//******************************************************************************
+void HostPlatform::RaiseInterrupt(ISR_FUNCTION isr)
+{
+    if (isr == NULL) return;
+
+    // If the calling thread has interrupts disabled the ISR has to wait, just
+    // as it would on real hardware.
+    if (t_interruptsOff)
+    {
+        std::lock_guard<std::mutex> lock(s_pendingLock);
+        s_pending.push_back(isr);
+        return;
+    }
+
+    _RunInterrupt(isr);
+
+    // An interrupt wakes the processor from sleep
+    Wake();
+}
+
+
+uint16_t HostPlatform::PendingInterrupts()
+{
+    std::lock_guard<std::mutex> lock(s_pendingLock);
+
+    return (uint16_t)s_pending.size();
+}
+
+
+//******************************************************************************
+// Sleeping
+//******************************************************************************
+void HostPlatform::Sleep(uint32_t micros)
+{
+    if (!t_interruptsOff) DisableInterrupts();
+
+    // A simulated clock doesn't advance while the thread waits, so the sleep is 
+    // simulated as well.
+    if (s_pClock != &s_systemClock)
+    {
+        bool isWoken = s_wakePending.exchange(false);
+
+        EnableInterrupts();
+
+        if (!isWoken) s_pClock->Delay(micros);
+
+        return;
+    }
+
+    {
+        // The gate is held while interrupts are disabled; waiting releases it,
+        // just like the sleep instruction lets interrupts in.
+        std::unique_lock<std::mutex> lock(s_gate, std::adopt_lock);
+
+        s_sleepers++;
+        s_wake.wait_for(lock, std::chrono::microseconds(micros), [] { return s_wakePending.exchange(false); });
+        s_sleepers--;
+
+        lock.release();
+    }
+
+    EnableInterrupts();
+}
+
+
+void HostPlatform::Wake()
+{
+    s_wakePending = true;
+
+    if (s_sleepers == 0) return;
+
+    // Notify while holding the gate, so the sleeper is either still before its
+    // wait (and will see s_wakePending) or already waiting.
+    if (t_interruptsOff)
+    {
+        s_wake.notify_all();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(s_gate);
+        s_wake.notify_all();
+    }
+}
+
+
+void HostPlatform::_RunInterrupt(ISR_FUNCTION isr)
+{
+    s_gate.lock();
+    t_interruptsOff = true;
+    t_isrDepth++;
+
+    (*isr)();
+
+    t_isrDepth--;
+    t_interruptsOff = false;
+    s_gate.unlock();
+}
+
+
+void HostPlatform::_DeliverPending()
+{
+    for (;;)
+    {
+        ISR_FUNCTION isr;
+
+        {
+            std::lock_guard<std::mutex> lock(s_pendingLock);
+
+            if (s_pending.empty()) return;
+
+            isr = s_pending.front();
+            s_pending.pop_front();
+        }
+
+        _RunInterrupt(isr);
+    }
+}
+
+
+//******************************************************************************
+// Arduino core functions
+//******************************************************************************
+unsigned long millis()
+{
+    return (unsigned long)(uint32_t)(HostPlatform::Clock().Micros() / 1000);
+}
+
+
+unsigned long micros()
+{
+    return (unsigned long)(uint32_t)HostPlatform::Clock().Micros();
+}
+
+
+void delay(unsigned long ms)
+{
+    HostPlatform::Clock().Delay((uint64_t)ms * 1000);
+}
+
+
+void delayMicroseconds(unsigned int us)
+{
+    HostPlatform::Clock().Delay(us);
+}
+
+
+void noInterrupts()
+{
+    HostPlatform::DisableInterrupts();
+}
+
+
+void interrupts()
+{
+    HostPlatform::EnableInterrupts();
+}
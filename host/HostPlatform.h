@@ -0,0 +1,161 @@
+#ifndef _HostPlatform_h_
+#define _HostPlatform_h_
+
+#include <stdint.h>
+
+
+typedef void (*ISR_FUNCTION)();
+
+
+/*******************************************************************************
+Defines an interface for the clock used by the host platform. This is an abstract
+base class that must be extended by a derived class.
+
+The host implementations of millis(), micros() and delay() are routed through the
+currently installed clock (see HostPlatform::SetClock()). This allows a program
+to run either against the real system clock or against a simulated clock that
+only advances when told to, which makes timing-dependent behavior repeatable.
+*******************************************************************************/
+class IHostClock
+{
+    protected: IHostClock() {};
+
+    public: virtual ~IHostClock() {};
+
+    /// Returns the number of microseconds elapsed since the clock was started
+    public: virtual uint64_t Micros() = 0;
+
+    /// Waits (or pretends to wait) for the given number of microseconds
+    public: virtual void Delay(uint64_t micros) = 0;
+};
+
+
+/*******************************************************************************
+A clock that tracks the host's monotonic system clock.
+*******************************************************************************/
+class SystemClock : public IHostClock
+{
+    public: SystemClock();
+
+    public: virtual uint64_t Micros();
+
+    public: virtual void Delay(uint64_t micros);
+
+    private: uint64_t _origin;
+};
+
+
+/*******************************************************************************
+A clock that only advances when Advance() or Delay() is called. Time never
+passes on its own, so a program driven by a SimulatedClock behaves identically
+on every run.
+*******************************************************************************/
+class SimulatedClock : public IHostClock
+{
+    public: SimulatedClock(uint64_t start=0) : _now(start) {};
+
+    public: virtual uint64_t Micros() { return _now; };
+
+    public: virtual void Delay(uint64_t micros) { _now += micros; };
+
+    /// Moves the clock forward by the given number of microseconds
+    public: void Advance(uint64_t micros) { _now += micros; };
+
+    /// Sets the clock to an absolute time
+    public: void Set(uint64_t micros) { _now = micros; };
+
+    private: volatile uint64_t _now;
+};
+
+
+/*******************************************************************************
+Platform layer used when the framework is compiled for a host (Linux) target.
+
+HostPlatform stands in for the parts of the Arduino core that the framework
+depends on:
+
+- The clock that backs millis(), micros() and delay(). It can be swapped at
+  runtime with SetClock().
+
+- The critical-section primitive that backs noInterrupts() and interrupts().
+  Disabling interrupts acquires a global gate which is released again when
+  interrupts are re-enabled, so code that runs between the two calls is atomic
+  with respect to simulated interrupts - even when those are raised from another
+  thread.
+
+- A simulated interrupt injector. RaiseInterrupt() runs an interrupt service
+  routine the same way the hardware would: immediately if interrupts are enabled,
+  or deferred until interrupts() is called if they are disabled on the calling
+  thread. ISRs always run with interrupts disabled. Nested interrupts are not
+  simulated; calling interrupts() from inside an ISR has no effect.
+
+- A sleep instruction. Sleep() blocks the calling thread until an interrupt is
+  raised, Wake() is called (e.g., when an event is queued from another thread)
+  or the given time has passed. It is the host's EventDispatcher sleep function
+  (see EventDispatcher::WaitForEvents()).
+*******************************************************************************/
+class HostPlatform
+{
+    // Private constructor prevents instances from being created
+    private: HostPlatform() {};
+
+    /***************************************************************************
+    Clock
+    ***************************************************************************/
+
+    /// Installs the clock used by millis(), micros() and delay().
+    /// Passing NULL restores the default system clock.
+    public: static void SetClock(IHostClock* pClock);
+
+    /// Returns the currently installed clock
+    public: static IHostClock& Clock();
+
+    /***************************************************************************
+    Critical sections
+    ***************************************************************************/
+
+    /// Disables (simulated) interrupts for the calling thread
+    public: static void DisableInterrupts();
+
+    /// Re-enables (simulated) interrupts and delivers any pending ISRs
+    public: static void EnableInterrupts();
+
+    /// Determines if interrupts are currently disabled on the calling thread
+    public: static bool InterruptsDisabled();
+
+    /// Determines if the calling thread is currently running an ISR
+    public: static bool InInterrupt();
+
+    /***************************************************************************
+    Interrupt injection
+    ***************************************************************************/
+
+    /// Raises a simulated interrupt that runs the given service routine
+    public: static void RaiseInterrupt(ISR_FUNCTION isr);
+
+    /// Returns the number of interrupts that are pending delivery
+    public: static uint16_t PendingInterrupts();
+
+    /***************************************************************************
+    Sleeping
+    ***************************************************************************/
+
+    /// Sleeps until an interrupt is raised, Wake() is called or 'micros' microseconds
+    /// have passed. Like the sleep instruction on a microcontroller it must be called
+    /// with interrupts disabled, and it returns with interrupts enabled. With a clock
+    /// other than the system clock the sleep advances the clock instead.
+    public: static void Sleep(uint32_t micros);
+
+    /// Wakes the thread that is sleeping in Sleep(), or makes the next call to Sleep()
+    /// return immediately if no thread is sleeping
+    public: static void Wake();
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+    private: static void _RunInterrupt(ISR_FUNCTION isr);
+
+    private: static void _DeliverPending();
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*******************************************************************************
+Dispatches events on a pool of worker threads. See ParallelDispatcher.h for
+details.
+*******************************************************************************/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ParallelDispatcher.h"
+#include "EventSource.h"
+
+
+/*******************************************************************************
+A queue of the events of the sources that hash to it. IsBusy is set while a worker
+is draining the shard.
+*******************************************************************************/
+struct Shard
+{
+    std::mutex Lock;
+    std::deque<Event> Events;
+    bool IsBusy = false;
+};
+
+
+static std::vector<std::unique_ptr<Shard>> s_shards;
+static std::vector<std::thread> s_workers;
+static uint8_t s_workerCount = 0;
+
+// The number of shards that have events and aren't being drained, and the number
+// of events that have been handed off but not dispatched yet
+static std::atomic<uint32_t> s_claimable(0);
+static std::atomic<uint64_t> s_pending(0);
+
+static std::atomic<uint64_t> s_dispatched(0);
+static std::atomic<uint64_t> s_steals(0);
+static std::atomic<bool> s_isRunning(false);
+
+// Idle workers wait on s_workReady; WaitIdle() waits on s_idle
+static std::mutex s_wait;
+static std::condition_variable s_workReady;
+static std::condition_variable s_idle;
+
+
+//******************************************************************************
+// Starts the worker threads
+//******************************************************************************
+void ParallelDispatcher::Start(uint8_t workers, uint16_t shards)
+{
+    if (s_isRunning || workers == 0) return;
+
+    if (shards == 0) shards = workers * 4;
+
+    s_shards.clear();
+
+    for (uint16_t i = 0; i < shards; i++) s_shards.emplace_back(new Shard());
+
+    s_workerCount = workers;
+    s_isRunning = true;
+
+    for (uint8_t i = 0; i < workers; i++) s_workers.emplace_back(_Work, i);
+
+    EventDispatcher::SetDispatchHandler(_Handoff);
+}
+
+
+//******************************************************************************
+// Waits for all handed-off events to be dispatched and stops the worker threads
+//******************************************************************************
+void ParallelDispatcher::Stop()
+{
+    if (!s_isRunning) return;
+
+    EventDispatcher::SetDispatchHandler(nullptr);
+    WaitIdle();
+
+    {
+        std::lock_guard<std::mutex> lock(s_wait);
+        s_isRunning = false;
+    }
+
+    s_workReady.notify_all();
+
+    for (std::thread& worker : s_workers) worker.join();
+
+    s_workers.clear();
+}
+
+
+//******************************************************************************
+// Waits until all events handed to the workers have been dispatched
+//******************************************************************************
+void ParallelDispatcher::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(s_wait);
+
+    s_idle.wait(lock, [] { return s_pending == 0; });
+}
+
+
+bool ParallelDispatcher::IsRunning() { return s_isRunning; }
+
+uint64_t ParallelDispatcher::Dispatched() { return s_dispatched; }
+
+uint64_t ParallelDispatcher::Steals() { return s_steals; }
+
+
+//******************************************************************************
+// Hands an event de-queued by EventDispatcher to the shard of its source
+//******************************************************************************
+void ParallelDispatcher::_Handoff(Event& event)
+{
+    uintptr_t key = (uintptr_t)event.Source;
+    Shard& shard = *s_shards[((key >> 4) ^ (key >> 12)) % s_shards.size()];
+    bool isClaimable;
+
+    s_pending++;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.Lock);
+
+        // A shard only becomes claimable when its first event arrives; events added
+        // while a worker is draining the shard are picked up by that worker.
+        isClaimable = !shard.IsBusy && shard.Events.empty();
+        shard.Events.push_back(event);
+    }
+
+    if (isClaimable)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_wait);
+            s_claimable++;
+        }
+
+        s_workReady.notify_one();
+    }
+}
+
+
+//******************************************************************************
+// The worker thread function
+//******************************************************************************
+void ParallelDispatcher::_Work(uint8_t worker)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(s_wait);
+
+            s_workReady.wait(lock, [] { return s_claimable > 0 || !s_isRunning; });
+
+            if (s_claimable == 0 && !s_isRunning) return;
+        }
+
+        // Claim a shard: first one of this worker's own shards (every s_workerCount'th
+        // shard), then any other shard
+        Shard* pShard = nullptr;
+
+        for (uint8_t pass = 0; pass < 2 && pShard == nullptr; pass++)
+        {
+            size_t step = (pass == 0) ? s_workerCount : 1;
+
+            for (size_t index = (pass == 0) ? worker : 0; index < s_shards.size() && pShard == nullptr; index += step)
+            {
+                Shard& shard = *s_shards[index];
+                std::lock_guard<std::mutex> lock(shard.Lock);
+
+                if (shard.IsBusy || shard.Events.empty()) continue;
+
+                shard.IsBusy = true;
+                pShard = &shard;
+                s_claimable--;
+
+                if (pass > 0) s_steals++;
+            }
+        }
+
+        if (pShard == nullptr) continue;
+
+        // Drain the shard. The shard is released under its lock once it is empty,
+        // so an event can't be left behind in a shard that no worker will claim.
+        for (;;)
+        {
+            Event event;
+
+            {
+                std::lock_guard<std::mutex> lock(pShard->Lock);
+
+                if (pShard->Events.empty())
+                {
+                    pShard->IsBusy = false;
+                    break;
+                }
+
+                event = pShard->Events.front();
+                pShard->Events.pop_front();
+            }
+
+            if (event.Source != nullptr) event.Source->DispatchEvent(event);
+
+#if EVENT_PAYLOAD_POOL_SIZE > 0
+            EventPayload::Release(event);
+#endif
+
+            s_dispatched++;
+
+            if (--s_pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(s_wait);
+                s_idle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef _Host_ParallelDispatcher_h_
+#define _Host_ParallelDispatcher_h_
+
+#include <stdint.h>
+
+#include "EventDispatcher.h"
+
+
+/*******************************************************************************
+Dispatches events on a pool of worker threads (host only).
+
+EventDispatcher dispatches every event on the thread that calls DispatchEvents().
+When ParallelDispatcher is started, the events that DispatchEvents() de-queues are
+handed to N worker threads instead (see EventDispatcher::SetDispatchHandler()),
+so the listeners of many sources can run on several cores. The thread that calls
+DispatchEvents() keeps polling the sources and draining the event queue.
+
+Events are sharded by source: all events of a source go to the same shard, and a
+shard is only ever drained by one worker at a time, in order. So the listeners of
+a source still receive its events one at a time and in the order they were
+queued; the events of different sources are dispatched concurrently. Each worker
+prefers its own shards, and an idle worker steals any shard that has events and
+isn't being drained.
+
+This only holds for the listeners attached to a source. A topic subscription (see
+EventLoop::Subscribe()) or a listener attached to several sources receives the
+events of all of them, from whichever workers dispatch them, so its OnEvent() can
+be called concurrently and must be thread-safe.
+
+Listeners may queue events from the worker threads (the default MultiProducer
+event queue is safe to use from any number of threads). Sources, bindings and
+listeners must not be attached or detached while the workers are running.
+*******************************************************************************/
+class ParallelDispatcher
+{
+    /***************************************************************************
+    Public Methods
+    ***************************************************************************/
+
+    /// Starts the worker threads. 'shards' is the number of source shards (0 = 4 per worker).
+    public: static void Start(uint8_t workers, uint16_t shards=0);
+
+    /// Waits for all handed-off events to be dispatched and stops the worker threads
+    public: static void Stop();
+
+    /// Waits until all events handed to the workers have been dispatched
+    public: static void WaitIdle();
+
+    /// Determines if the worker threads are running
+    public: static bool IsRunning();
+
+    /// The number of events the workers have dispatched
+    public: static uint64_t Dispatched();
+
+    /// The number of shards that idle workers have stolen from other workers
+    public: static uint64_t Steals();
+
+    /***************************************************************************
+    Internal implementation
+    ***************************************************************************/
+
+    /// Hands an event de-queued by EventDispatcher to the shard of its source
+    private: static void _Handoff(Event& event);
+
+    /// The worker thread function
+    private: static void _Work(uint8_t worker);
+};
+
+#endif
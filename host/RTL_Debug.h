@@ -0,0 +1,57 @@
+#ifndef _Host_RTL_Debug_h_
+#define _Host_RTL_Debug_h_
+
+/*******************************************************************************
+Host (Linux) stand-in for the RTL_Debug library header.
+
+Only the subset of RTL_Debug that the event framework uses is provided. Log output
+is written to stderr.
+*******************************************************************************/
+
+#include <stdint.h>
+#include <iostream>
+
+
+#ifndef DEBUG
+#define DEBUG 0
+#endif
+
+#if DEBUG
+#define TRACE(x) x
+#else
+#define TRACE(x)
+#endif
+
+#define PTR(p)  ((uintptr_t)(p))
+
+
+struct _HexValue
+{
+    explicit _HexValue(uintptr_t value) : Value(value) {};
+
+    uintptr_t Value;
+};
+
+template<typename T> inline _HexValue _HEX(T value) { return _HexValue((uintptr_t)value); }
+
+
+enum _EndLineCode { endl };
+
+
+class Logger
+{
+    public: Logger(const char* classname, const void* pObject=NULL)
+    {
+        std::cerr << classname;
+        if (pObject != NULL) std::cerr << '[' << pObject << ']';
+        std::cerr << ": ";
+    };
+
+    public: template<typename T> Logger& operator<<(const T& value) { std::cerr << value; return *this; };
+
+    public: Logger& operator<<(_HexValue value) { std::cerr << "0x" << std::hex << value.Value << std::dec; return *this; };
+
+    public: Logger& operator<<(_EndLineCode) { std::cerr << std::endl; return *this; };
+};
+
+#endif
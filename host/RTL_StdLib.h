@@ -0,0 +1,17 @@
+#ifndef _Host_RTL_StdLib_h_
+#define _Host_RTL_StdLib_h_
+
+/*******************************************************************************
+Host (Linux) stand-in for the RTL_StdLib library header.
+
+Only the subset of RTL_StdLib that the event framework uses is provided.
+*******************************************************************************/
+
+#include <Arduino.h>
+#include "RTL_Debug.h"
+
+
+#define DECLARE_CLASSNAME       static const char* _classname_
+#define DEFINE_CLASSNAME(cls)   const char* cls::_classname_ = #cls
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _Host_RTL_Variant_h_
+#define _Host_RTL_Variant_h_
+
+/*******************************************************************************
+Host (Linux) stand-in for the RTL_Variant library header.
+
+Only the subset of RTL_Variant that the event framework uses is provided.
+*******************************************************************************/
+
+#include <stdint.h>
+
+
+union variant_union_t
+{
+    bool     Bool;
+    int8_t   Char;
+    uint8_t  Byte;
+    int16_t  Int;
+    uint16_t UnsignedInt;
+    int32_t  Long;
+    uint32_t UnsignedLong;
+    float    Float;
+    void*    Pointer;
+};
+
+
+class variant_t
+{
+    public: variant_t()                  { _value.Long = 0; };
+    public: variant_t(bool value)        { _value.Long = 0; _value.Bool = value; };
+    public: variant_t(int16_t value)     { _value.Long = 0; _value.Int = value; };
+    public: variant_t(uint16_t value)    { _value.Long = 0; _value.UnsignedInt = value; };
+    public: variant_t(int32_t value)     { _value.Long = value; };
+    public: variant_t(uint32_t value)    { _value.UnsignedLong = value; };
+    public: variant_t(long value)        { _value.Long = (int32_t)value; };
+    public: variant_t(unsigned long value) { _value.UnsignedLong = (uint32_t)value; };
+    public: variant_t(float value)       { _value.Float = value; };
+    public: variant_t(void* value)       { _value.Pointer = value; };
+    public: variant_t(variant_union_t value) : _value(value) { };
+
+    public: operator variant_union_t() const { return _value; };
+
+    private: variant_union_t _value;
+};
+
+#endif
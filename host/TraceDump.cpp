@@ -0,0 +1,226 @@
+/*******************************************************************************
+Host tool that turns a binary trace dump (see EventTrace::Dump()) into a timeline.
+
+Each record is printed with its time relative to the first record and the time
+since the previous record. Records that end a span are annotated with the span's
+duration:
+
+    Dequeue      - time the event waited in the queue (since its Enqueue record)
+    DispatchEnd  - time the source's listeners took to handle the event
+    PollEnd      - time the object's Poll() method took
+
+Spans that take at least 'spike-micros' are flagged with '<-- SPIKE' so they can
+be found with grep. A summary of the longest spans is printed at the end.
+
+Usage: TraceDump <dump-file> [spike-micros]
+*******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <EventTrace.h>
+
+
+static const char* TypeName(uint8_t type)
+{
+    switch (type)
+    {
+        case EventTraceType::Enqueue:     return "Enqueue";
+        case EventTraceType::Drop:        return "Drop";
+        case EventTraceType::Dequeue:     return "Dequeue";
+        case EventTraceType::Dispatch:    return "Dispatch";
+        case EventTraceType::DispatchEnd: return "DispatchEnd";
+        case EventTraceType::PollStart:   return "PollStart";
+        case EventTraceType::PollEnd:     return "PollEnd";
+        default:                          return "?";
+    }
+}
+
+
+static uint32_t ReadU32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t ReadU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+
+static bool ReadDump(FILE* file, std::vector<EventTraceRecord>& records)
+{
+    uint8_t header[8];
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) return false;
+
+    if (header[0] != 'E' || header[1] != 'V' || header[2] != 'T' || header[3] != 'R') return false;
+
+    if (header[4] != 1 || header[5] < 12) return false;
+
+    uint8_t recordSize = header[5];
+    uint16_t count = ReadU16(header + 6);
+    std::vector<uint8_t> buffer(recordSize);
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (fread(buffer.data(), 1, recordSize, file) != recordSize) return false;
+
+        EventTraceRecord record;
+
+        record.Time    = ReadU32(&buffer[0]);
+        record.Source  = ReadU32(&buffer[4]);
+        record.EventID = ReadU16(&buffer[8]);
+        record.Type    = buffer[10];
+        record.Info    = buffer[11];
+
+        records.push_back(record);
+    }
+
+    return true;
+}
+
+
+struct SpanStats
+{
+    uint32_t Count = 0;
+    uint32_t Max = 0;
+    uint64_t Total = 0;
+
+    void Add(uint32_t duration) { Count++; Total += duration; if (duration > Max) Max = duration; }
+};
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <dump-file> [spike-micros]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t spikeMicros = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 1000;
+
+    FILE* file = fopen(argv[1], "rb");
+
+    if (file == nullptr)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    std::vector<EventTraceRecord> records;
+    bool isValid = ReadDump(file, records);
+
+    fclose(file);
+
+    if (!isValid)
+    {
+        fprintf(stderr, "%s: not a valid (or a truncated) trace dump\n", argv[1]);
+        return 1;
+    }
+
+    // The start of each open span. Events are queued in FIFO order, so the enqueue
+    // times of the events pending for each source and event ID are kept in a queue.
+    std::map<std::pair<uint32_t, uint16_t>, std::deque<uint32_t>> enqueued;
+    std::map<uint32_t, std::vector<uint32_t>> dispatching;
+    std::map<uint32_t, uint32_t> polling;
+
+    SpanStats queueStats, dispatchStats, pollStats;
+    uint32_t drops = 0;
+    uint32_t spikes = 0;
+
+    printf("%12s %10s  %-11s  %-10s  %-6s  %-4s  %s\n", "time(us)", "delta(us)", "type", "source", "event", "info", "span(us)");
+
+    uint32_t start = records.empty() ? 0 : records.front().Time;
+    uint32_t previous = start;
+
+    for (const EventTraceRecord& record : records)
+    {
+        // micros() wraps around every ~71 minutes, so all times are computed as
+        // unsigned differences
+        long span = -1;
+
+        switch (record.Type)
+        {
+            case EventTraceType::Enqueue:
+                enqueued[std::make_pair(record.Source, record.EventID)].push_back(record.Time);
+                break;
+
+            case EventTraceType::Drop:
+                drops++;
+                break;
+
+            case EventTraceType::Dequeue:
+            {
+                std::deque<uint32_t>& pending = enqueued[std::make_pair(record.Source, record.EventID)];
+
+                if (!pending.empty())
+                {
+                    span = record.Time - pending.front();
+                    pending.pop_front();
+                    queueStats.Add(span);
+                }
+                break;
+            }
+
+            case EventTraceType::Dispatch:
+                dispatching[record.Source].push_back(record.Time);
+                break;
+
+            case EventTraceType::DispatchEnd:
+            {
+                std::vector<uint32_t>& open = dispatching[record.Source];
+
+                if (!open.empty())
+                {
+                    span = record.Time - open.back();
+                    open.pop_back();
+                    dispatchStats.Add(span);
+                }
+                break;
+            }
+
+            case EventTraceType::PollStart:
+                polling[record.Source] = record.Time;
+                break;
+
+            case EventTraceType::PollEnd:
+            {
+                auto it = polling.find(record.Source);
+
+                if (it != polling.end())
+                {
+                    span = record.Time - it->second;
+                    polling.erase(it);
+                    pollStats.Add(span);
+                }
+                break;
+            }
+        }
+
+        printf("%12lu %10lu  %-11s  0x%08lx  0x%04x  %4u",
+            (unsigned long)(uint32_t)(record.Time - start), (unsigned long)(uint32_t)(record.Time - previous),
+            TypeName(record.Type), (unsigned long)record.Source, record.EventID, record.Info);
+
+        if (span >= 0) printf("  %8ld", span);
+
+        if (span >= (long)spikeMicros) { printf("  <-- SPIKE"); spikes++; }
+
+        printf("\n");
+
+        previous = record.Time;
+    }
+
+    printf("\n%lu records, %lu dropped events, %lu spans of %lu us or more\n",
+        (unsigned long)records.size(), (unsigned long)drops, (unsigned long)spikes, (unsigned long)spikeMicros);
+
+    const char* names[] = { "queue wait", "dispatch", "poll" };
+    const SpanStats* stats[] = { &queueStats, &dispatchStats, &pollStats };
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (stats[i]->Count == 0) continue;
+
+        printf("%-10s  count=%lu  avg=%.1f us  max=%lu us\n", names[i], (unsigned long)stats[i]->Count,
+            (double)stats[i]->Total / stats[i]->Count, (unsigned long)stats[i]->Max);
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*******************************************************************************
+Tests of batched dispatching to batch listeners.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+/*******************************************************************************
+A batch listener that records the size of each batch it receives.
+*******************************************************************************/
+class TestBatchListener : public IBatchEventListener
+{
+    public: virtual void OnEvents(const Event* pEvents, size_t count)
+    {
+        if (Calls < 16) Sizes[Calls] = count;
+
+        for (size_t i = 0; i < count; i++) Events[Count++ & 63] = pEvents[i];
+
+        Calls++;
+    };
+
+    public: void Clear() { Calls = 0; Count = 0; };
+
+    public: int Calls = 0;
+    public: int Count = 0;
+    public: size_t Sizes[16];
+    public: Event Events[64];
+};
+
+
+static TestSource a("a");
+static TestSource b("b");
+static TestBatchListener batchListener;
+static TestListener listener;
+
+
+static void TestBatchesBySource()
+{
+    IEventBinding* pBatch = a.Attach(batchListener);
+    IEventBinding* pSingle = b.Attach(listener);
+
+    CHECK(a.Queue(TimerFiredEvent, 1));
+    CHECK(b.Queue(TimerFiredEvent, 2));
+    CHECK(a.Queue(TimerFiredEvent, 3));
+    CHECK(b.Queue(TimerFiredEvent, 4));
+    CHECK(a.Queue(TimerFiredEvent, 5));
+
+    DrainEvents();
+
+    // The source's events come in one span, in order
+    CHECK_EQUAL(1, batchListener.Calls);
+    CHECK_EQUAL(3, batchListener.Sizes[0]);
+    CHECK_EQUAL(1, batchListener.Events[0].Data.Long);
+    CHECK_EQUAL(3, batchListener.Events[1].Data.Long);
+    CHECK_EQUAL(5, batchListener.Events[2].Data.Long);
+
+    CHECK_EQUAL(2, listener.Count);
+    CHECK_EQUAL(2, listener.Events[0].Data.Long);
+    CHECK_EQUAL(4, listener.Events[1].Data.Long);
+
+    a.Detach(*pBatch);
+    b.Detach(*pSingle);
+    batchListener.Clear();
+    listener.Clear();
+}
+
+
+static void TestDirectDispatch()
+{
+    IEventBinding* pBatch = a.Attach(batchListener);
+
+    // Events that don't come from the queue arrive in spans of one
+    a.Dispatch(TimerFiredEvent, 1);
+    a.Dispatch(TimerFiredEvent, 2);
+
+    CHECK_EQUAL(2, batchListener.Calls);
+    CHECK_EQUAL(1, batchListener.Sizes[1]);
+
+    a.Detach(*pBatch);
+    batchListener.Clear();
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+
+    RUN_TEST(TestBatchesBySource);
+    RUN_TEST(TestDirectDispatch);
+
+    return TestHarness::Failures();
+}
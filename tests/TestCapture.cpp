@@ -0,0 +1,95 @@
+/*******************************************************************************
+Tests of event capture and replay, and of the trace recorder.
+*******************************************************************************/
+#include <vector>
+#include "EventReplay.h"
+#include "TestHarness.h"
+
+
+static TestSource button("Button1");
+static TestSource thermometer("Thermometer");
+static TestListener listener;
+static std::vector<uint8_t> capture;
+
+
+static void WriteCapture(const uint8_t* data, uint16_t length)
+{
+    capture.insert(capture.end(), data, data + length);
+}
+
+
+static void TestCaptureAndReplay()
+{
+    EventCapture::Start(WriteCapture);
+
+    button.Dispatch(EventSourceID::Switch | EventCode::Toggle, 1);
+    thermometer.Dispatch(EventSourceID::Switch | EventCode::Update, 21);
+    button.Dispatch(EventSourceID::Switch | EventCode::Toggle, 0);
+
+    EventCapture::Stop();
+    button.Dispatch(TimerFiredEvent);
+
+    listener.Clear();
+
+    EventReplay replay;
+
+    CHECK(replay.Load(capture.data(), capture.size()));
+    CHECK_EQUAL(3, replay.Count());
+    CHECK_EQUAL(2, replay.SourceCount());
+    CHECK(replay.Map("Button1", button));
+    CHECK(replay.Map("Thermometer", thermometer));
+    CHECK(!replay.Map("Keypad", button));
+
+    CHECK_EQUAL(3, replay.Run(ReplayMode::Max));
+
+    CHECK_EQUAL(3, listener.Count);
+    CHECK(listener.Events[0].Source == &button);
+    CHECK_EQUAL(1, listener.Events[0].Data.Long);
+    CHECK(listener.Events[1].Source == &thermometer);
+    CHECK_EQUAL(21, listener.Events[1].Data.Long);
+    CHECK_EQUAL(0, listener.Events[2].Data.Long);
+
+    listener.Clear();
+}
+
+
+static void TestTrace()
+{
+    EventTraceRecord records[EVENT_TRACE_SIZE];
+
+    EventTrace::Clear();
+
+    button.Queue(TimerFiredEvent);
+    EventDispatcher::DispatchEvents();
+
+    uint16_t count = EventTrace::Snapshot(records, EVENT_TRACE_SIZE);
+    bool isSeen[EventTraceType::PollEnd + 1] = { false };
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (records[i].Type <= EventTraceType::PollEnd) isSeen[records[i].Type] = true;
+    }
+
+    CHECK(isSeen[EventTraceType::Enqueue]);
+    CHECK(isSeen[EventTraceType::Dequeue]);
+    CHECK(isSeen[EventTraceType::Dispatch]);
+    CHECK(isSeen[EventTraceType::DispatchEnd]);
+    CHECK(isSeen[EventTraceType::PollStart]);
+
+    listener.Clear();
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+    button.Attach(listener);
+    thermometer.Attach(listener);
+
+    RUN_TEST(TestCaptureAndReplay);
+    RUN_TEST(TestTrace);
+
+    return TestHarness::Failures();
+}
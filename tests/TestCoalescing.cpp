@@ -0,0 +1,199 @@
+/*******************************************************************************
+Tests of event coalescing.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static const EVENT_ID SONAR_UPDATE = EventSourceID::SonarSensor | EventCode::Update;
+
+static TestSource sonar("sonar");
+static TestSource other("other");
+static TestListener listener;
+
+
+static void TestCoalescingSource()
+{
+    sonar.SetCoalescing();
+
+    CHECK(sonar.Queue(SONAR_UPDATE, 1));
+    CHECK(other.Queue(TimerFiredEvent));
+    CHECK(sonar.Queue(SONAR_UPDATE, 2));
+    CHECK(sonar.Queue(SONAR_UPDATE, 3));
+
+    DrainEvents();
+
+    // The latest data is dispatched in the place of the first event
+    CHECK_EQUAL(2, listener.Count);
+    CHECK_EQUAL(SONAR_UPDATE, listener.Events[0].EventID);
+    CHECK_EQUAL(3, listener.Events[0].Data.Long);
+    CHECK(listener.Events[0].Source == &sonar);
+    CHECK_EQUAL(TimerFiredEvent, listener.Events[1].EventID);
+
+    // Once dispatched, the next event is queued again
+    CHECK(sonar.Queue(SONAR_UPDATE, 4));
+    DrainEvents();
+    CHECK_EQUAL(3, listener.Count);
+    CHECK_EQUAL(4, listener.Events[2].Data.Long);
+
+    sonar.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+static void TestCoalescingEventID()
+{
+    CHECK(EventDispatcher::SetCoalescing(SONAR_UPDATE));
+
+    // Events of different sources, or with different IDs, are kept apart
+    CHECK(sonar.Queue(SONAR_UPDATE, 1));
+    CHECK(other.Queue(SONAR_UPDATE, 2));
+    CHECK(sonar.Queue(TimerFiredEvent, 3));
+    CHECK(sonar.Queue(SONAR_UPDATE, 4));
+    CHECK(other.Queue(SONAR_UPDATE, 5));
+
+    DrainEvents();
+
+    CHECK_EQUAL(3, listener.Count);
+    CHECK_EQUAL(4, listener.Events[0].Data.Long);
+    CHECK_EQUAL(5, listener.Events[1].Data.Long);
+    CHECK_EQUAL(3, listener.Events[2].Data.Long);
+
+    CHECK(EventDispatcher::SetCoalescing(SONAR_UPDATE, false));
+
+    CHECK(sonar.Queue(SONAR_UPDATE, 6));
+    CHECK(sonar.Queue(SONAR_UPDATE, 7));
+    DrainEvents();
+    CHECK_EQUAL(5, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestCoalescingFullQueue()
+{
+    Event event;
+
+    sonar.SetCoalescing();
+
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) CHECK(other.Queue(TimerFiredEvent));
+
+    // The queue has no room for the placeholder, so the event is rejected and
+    // its slot is free again
+    CHECK(!sonar.Queue(SONAR_UPDATE, 1));
+    CHECK(!sonar.Queue(SONAR_UPDATE, 2));
+
+    CHECK(EventDispatcher::Dequeue(event));
+    CHECK(sonar.Queue(SONAR_UPDATE, 3));
+
+    DrainEvents();
+
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, listener.Count);
+    CHECK_EQUAL(3, listener.Events[EVENT_QUEUE_SIZE - 1].Data.Long);
+
+    sonar.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+static bool isrQueued;
+
+static void CoalesceFromISR()
+{
+    isrQueued = sonar.Queue(SONAR_UPDATE, 2);
+}
+
+
+static void TestCoalescingIntoClaimedSlot()
+{
+    sonar.SetCoalescing();
+
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) CHECK(other.Queue(TimerFiredEvent));
+
+    // The interrupt is deferred until the lookup re-enables interrupts, so the 
+    // ISR runs after a slot is claimed but before its placeholder is queued. The
+    // placeholder finds the queue full, so both events must be rejected.
+    isrQueued = true;
+
+    noInterrupts();
+    HostPlatform::RaiseInterrupt(CoalesceFromISR);
+    CHECK(!sonar.Queue(SONAR_UPDATE, 1));
+    interrupts();
+
+    CHECK(!isrQueued);
+
+    DrainEvents();
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, listener.Count);
+
+    sonar.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+static void TestOverwrittenPlaceholder()
+{
+    sonar.SetCoalescing();
+
+    CHECK(sonar.Queue(SONAR_UPDATE, 1));
+
+    // The queue drops the oldest event, the placeholder, to make room
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) CHECK(other.Queue(TimerFiredEvent));
+
+    // The next event isn't merged into the dropped one, but queued again
+    CHECK(sonar.Queue(SONAR_UPDATE, 2));
+
+    DrainEvents();
+
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, listener.Count);
+    CHECK_EQUAL(SONAR_UPDATE, listener.Events[EVENT_QUEUE_SIZE - 1].EventID);
+    CHECK_EQUAL(2, listener.Events[EVENT_QUEUE_SIZE - 1].Data.Long);
+
+    sonar.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+static void TestDequeueCoalesced()
+{
+    Event event;
+
+    sonar.SetCoalescing();
+
+    CHECK(sonar.Queue(SONAR_UPDATE, 1));
+    CHECK(sonar.Queue(SONAR_UPDATE, 2));
+
+    // The application gets the coalesced event, not the placeholder
+    CHECK(EventDispatcher::Dequeue(event));
+    CHECK_EQUAL(SONAR_UPDATE, event.EventID);
+    CHECK_EQUAL(2, event.Data.Long);
+    CHECK(event.Source == &sonar);
+    CHECK(!EventDispatcher::Dequeue(event));
+
+    sonar.SetCoalescing(false);
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+    sonar.Attach(listener);
+    other.Attach(listener);
+
+    RUN_TEST(TestCoalescingSource);
+    RUN_TEST(TestCoalescingEventID);
+
+    if (EVENT_QUEUE_OVERFLOW_POLICY == QueueOverflowPolicy::OverwriteOldest)
+    {
+        RUN_TEST(TestOverwrittenPlaceholder);
+    }
+    else
+    {
+        RUN_TEST(TestCoalescingFullQueue);
+        RUN_TEST(TestCoalescingIntoClaimedSlot);
+    }
+
+    RUN_TEST(TestDequeueCoalesced);
+
+    return TestHarness::Failures();
+}
@@ -0,0 +1,259 @@
+/*******************************************************************************
+Tests of event dispatching: bindings and subscriptions, binding pools, member
+bindings, priority lanes, time-budgeted dispatching and handler tables.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static const EVENT_ID SWITCH_TOGGLE = EventSourceID::Switch | EventCode::Toggle;
+
+static TestSource source("source");
+static TestSource other("other");
+static TestListener listener;
+static TestListener listener2;
+
+// A global whose constructor attaches a listener, as sketches do. It can run before
+// the globals of the library, including its binding pool.
+static TestSource early("early");
+static IEventBinding* pEarlyBinding = early.Attach(listener);
+
+
+static void TestAttachDetach()
+{
+    IEventBinding* pBinding = source.Attach(listener);
+
+    CHECK(pBinding != NULL);
+    CHECK(source.Attach(listener) == pBinding);     // Attaching twice reuses the binding
+    CHECK(source.HasListeners());
+
+    source.Queue(TimerFiredEvent, 7);
+    DrainEvents();
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(7, listener.Events[0].Data.Long);
+    CHECK(listener.Events[0].Source == &source);
+
+    source.Detach(*pBinding);
+    CHECK(!source.HasListeners());
+
+    source.Dispatch(TimerFiredEvent);
+    CHECK_EQUAL(1, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestSubscriptions()
+{
+    IEventBinding* pExact = source.Subscribe(listener, SWITCH_TOGGLE);
+    IEventBinding* pClass = source.Subscribe(listener2, EventSourceID::Switch, EventMask::SourceID);
+
+    source.Dispatch(SWITCH_TOGGLE);
+    source.Dispatch(EventSourceID::Switch | EventCode::Detect);
+    source.Dispatch(TimerFiredEvent);
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(2, listener2.Count);
+
+    source.Detach(*pExact);
+    source.Detach(*pClass);
+    listener.Clear();
+    listener2.Clear();
+}
+
+
+static void TestEarlyBinding()
+{
+    IEventBinding* pBinding = source.Attach(listener2);
+
+    // Had the pool been set up after the early binding was allocated, it would
+    // hand out the same block again
+    CHECK(pEarlyBinding != NULL && pBinding != NULL && pBinding != pEarlyBinding);
+
+    early.Dispatch(TimerFiredEvent);
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(0, listener2.Count);
+
+    source.Detach(*pBinding);
+    early.Detach(*pEarlyBinding);
+    listener.Clear();
+}
+
+
+static void TestBindingPool()
+{
+    // The pool has EVENT_BINDING_POOL_SIZE (2) bindings
+    IEventBinding* p1 = source.Subscribe(listener, 1);
+    IEventBinding* p2 = source.Subscribe(listener, 2);
+
+    CHECK(p1 != NULL && p2 != NULL);
+    CHECK(source.Subscribe(listener, 3) == NULL);
+
+    source.Detach(*p1);
+
+    IEventBinding* p3 = source.Subscribe(listener, 3);
+
+    CHECK(p3 != NULL);
+
+    source.Detach(*p2);
+    source.Detach(*p3);
+
+    // Detaching a binding twice returns its block to the pool only once
+    p1 = source.Subscribe(listener, 1);
+    source.Detach(*p1);
+    source.Detach(*p1);
+
+    p1 = source.Subscribe(listener, 1);
+    p2 = source.Subscribe(listener, 2);
+
+    CHECK(p1 != NULL && p2 != NULL && p1 != p2);
+
+    source.Detach(*p1);
+    source.Detach(*p2);
+}
+
+
+class Robot
+{
+    public: void OnDetect(const Event* pEvent) { Detected++; };
+    public: void OnBump(const Event* pEvent) { Bumped++; };
+
+    public: int Detected = 0;
+    public: int Bumped = 0;
+};
+
+
+static void TestMemberBindings()
+{
+    Robot robot;
+    MemberBinding<Robot, &Robot::OnDetect> detectBinding(robot);
+    MemberBinding<Robot, &Robot::OnBump> bumpBinding(robot);
+
+    source.Attach(detectBinding);
+    other.Attach(bumpBinding);
+
+    source.Dispatch(1);
+    source.Dispatch(2);
+    other.Dispatch(3);
+
+    CHECK_EQUAL(2, robot.Detected);
+    CHECK_EQUAL(1, robot.Bumped);
+
+    source.Detach(detectBinding);
+    other.Detach(bumpBinding);
+}
+
+
+static void TestPriorityLanes()
+{
+    IEventBinding* pBinding = source.Attach(listener);
+
+    CHECK(EventDispatcher::SetEventPriority(EventCode::Aborted, EventPriority::Highest));
+    CHECK_EQUAL(EventPriority::Highest, EventDispatcher::GetEventPriority(TaskAbortedEvent));
+
+    source.Queue(TimerFiredEvent, 0, 2);
+    source.Queue(TimerFiredEvent, 1);
+    source.Queue(TaskAbortedEvent);
+    DrainEvents();
+
+    // Strict scheduling dispatches the lanes in priority order
+    CHECK_EQUAL(3, listener.Count);
+    CHECK_EQUAL(TaskAbortedEvent, listener.Events[0].EventID);
+    CHECK_EQUAL(1, listener.Events[1].Data.Long);
+    CHECK_EQUAL(0, listener.Events[2].Data.Long);
+
+    source.Detach(*pBinding);
+    listener.Clear();
+}
+
+
+static void TestBudgetedDispatch()
+{
+    int polls = source.PollCount + other.PollCount;
+
+    // With a simulated clock that doesn't advance, the budget is never used up, so
+    // the dispatcher must stop by itself after an idle round of the polling list
+    uint32_t used = EventDispatcher::DispatchEvents(1000000);
+
+    CHECK_EQUAL(0, used);
+    CHECK(source.PollCount + other.PollCount - polls >= 2);
+}
+
+
+class TableListener : public IEventListener
+{
+    public: void OnEvent(const Event* pEvent)
+    {
+        WithEventTable(TableListener, pEvent)
+        {
+            { TimerFiredEvent,   &TableListener::OnTimer },
+            { SWITCH_TOGGLE, &TableListener::OnToggle },
+            { TaskAbortedEvent,  &TableListener::OnAborted },
+        };
+        IsHandled = DispatchEventTable;
+    };
+
+    public: bool Dense(const Event* pEvent)
+    {
+        WithEventTable(TableListener, pEvent)
+        {
+            { EventSourceID::Switch | EventCode::Detect,  &TableListener::OnTimer },
+            { EventSourceID::Switch | EventCode::Trigger, &TableListener::OnToggle },
+            { EventSourceID::Switch | EventCode::Toggle,  &TableListener::OnAborted },
+        };
+        return DispatchEventTable;
+    };
+
+    private: void OnTimer(const Event* pEvent) { Handled[0]++; };
+    private: void OnToggle(const Event* pEvent) { Handled[1]++; };
+    private: void OnAborted(const Event* pEvent) { Handled[2]++; };
+
+    public: int Handled[3] = { 0, 0, 0 };
+    public: bool IsHandled = false;
+};
+
+
+static void TestHandlerTables()
+{
+    TableListener tableListener;
+    Event timer(TimerFiredEvent), toggle(SWITCH_TOGGLE), aborted(TaskAbortedEvent), unknown(0x0A01);
+
+    tableListener.OnEvent(&toggle);
+    CHECK(tableListener.IsHandled);
+    tableListener.OnEvent(&aborted);
+    tableListener.OnEvent(&timer);
+    tableListener.OnEvent(&unknown);
+    CHECK(!tableListener.IsHandled);
+
+    CHECK_EQUAL(1, tableListener.Handled[0]);
+    CHECK_EQUAL(1, tableListener.Handled[1]);
+    CHECK_EQUAL(1, tableListener.Handled[2]);
+
+    Event detect(EventSourceID::Switch | EventCode::Detect), below(EventSourceID::Switch | EventCode::DebugInfo);
+
+    CHECK(tableListener.Dense(&detect));
+    CHECK(tableListener.Dense(&toggle));
+    CHECK(!tableListener.Dense(&below));
+    CHECK(!tableListener.Dense(&timer));
+    CHECK_EQUAL(2, tableListener.Handled[0]);
+    CHECK_EQUAL(2, tableListener.Handled[2]);
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+
+    RUN_TEST(TestEarlyBinding);
+    RUN_TEST(TestAttachDetach);
+    RUN_TEST(TestSubscriptions);
+    RUN_TEST(TestBindingPool);
+    RUN_TEST(TestMemberBindings);
+    RUN_TEST(TestPriorityLanes);
+    RUN_TEST(TestBudgetedDispatch);
+    RUN_TEST(TestHandlerTables);
+
+    return TestHarness::Failures();
+}
@@ -0,0 +1,131 @@
+#ifndef _TestHarness_h_
+#define _TestHarness_h_
+
+#include <stdio.h>
+#include <RTL_EventFramework.h>
+
+
+/// Checks a condition, and reports it if it doesn't hold
+#define CHECK(condition) TestHarness::Check((condition), #condition, __FILE__, __LINE__)
+
+/// Checks that a value is the expected value, and reports both if it isn't
+#define CHECK_EQUAL(expected, actual) TestHarness::CheckEqual((long long)(expected), (long long)(actual), #actual, __FILE__, __LINE__)
+
+/// Runs a test function
+#define RUN_TEST(test) TestHarness::Run(test, #test)
+
+
+/*******************************************************************************
+A minimal test harness for the host tests (see tests/CMakeLists.txt).
+
+Each test program is a list of test functions run by main() with RUN_TEST; the
+program's exit code is the number of failed checks, so ctest reports any failure.
+
+The framework's objects are meant to live for the lifetime of the program, so
+the event sources and listeners a test uses are globals. Each test removes the
+objects it added to a loop and leaves the event queue empty.
+*******************************************************************************/
+class TestHarness
+{
+    /// Runs a test function
+    public: static void Run(void (*pfTest)(), const char* name)
+    {
+        int failures = Failures();
+
+        pfTest();
+
+        printf("%s %s\n", (Failures() == failures) ? "PASS" : "FAIL", name);
+    };
+
+    public: static void Check(bool condition, const char* text, const char* file, int line)
+    {
+        if (condition) return;
+
+        printf("%s:%d: check failed: %s\n", file, line, text);
+        Failures()++;
+    };
+
+    public: static void CheckEqual(long long expected, long long actual, const char* text, const char* file, int line)
+    {
+        if (expected == actual) return;
+
+        printf("%s:%d: check failed: %s is %lld, expected %lld\n", file, line, text, actual, expected);
+        Failures()++;
+    };
+
+    /// The number of failed checks
+    public: static int& Failures()
+    {
+        static int failures = 0;
+
+        return failures;
+    };
+};
+
+
+/*******************************************************************************
+An event source whose events are queued and dispatched by the tests.
+*******************************************************************************/
+class TestSource : public EventSource
+{
+    public: TestSource(const char* id="test") { _id = id; };
+
+    public: bool Queue(EVENT_ID eventID, int32_t data=0, uint8_t priority=EventPriority::Default)
+    {
+        return QueueEvent(eventID, variant_t(data), priority);
+    };
+
+    public: bool Queue(Event& event, uint8_t priority=EventPriority::Default) { return QueueEvent(event, priority); };
+
+    public: void Dispatch(EVENT_ID eventID, int32_t data=0) { DispatchEvent(eventID, variant_t(data)); };
+
+    public: uint16_t Capacity(EVENT_ID eventID, uint8_t priority=EventPriority::Default) { return QueueCapacity(eventID, priority); };
+
+#if EVENT_SCHEDULED_POLLING && EVENT_TIMER_POOL_SIZE > 0
+    public: EVENT_TIMER QueueAfter(EVENT_ID eventID, uint32_t delayMicros)
+    {
+        Event event(eventID);
+
+        return QueueEventAfter(event, delayMicros);
+    };
+
+    public: EVENT_TIMER QueueEvery(EVENT_ID eventID, uint32_t periodMicros)
+    {
+        Event event(eventID);
+
+        return QueueEventEvery(event, periodMicros);
+    };
+#endif
+
+    public: virtual void Poll() { PollCount++; };
+
+    public: int PollCount = 0;
+};
+
+
+/*******************************************************************************
+An event listener that records the events it receives.
+*******************************************************************************/
+class TestListener : public IEventListener
+{
+    public: virtual void OnEvent(const Event* pEvent)
+    {
+        if (Count < 64) Events[Count] = *pEvent;
+
+        Count++;
+    };
+
+    public: void Clear() { Count = 0; };
+
+    public: int Count = 0;
+    public: Event Events[64];
+};
+
+
+/// Runs enough dispatch passes to empty the event queue of the tests
+inline void DrainEvents(EventLoop& loop=EventDispatcher::Default())
+{
+    for (int i = 0; i < 64; i++) loop.DispatchEvents();
+}
+
+#endif
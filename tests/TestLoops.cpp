@@ -0,0 +1,156 @@
+/*******************************************************************************
+Tests of multiple event loops and of topic subscriptions.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static const EVENT_ID SWITCH_TOGGLE = EventSourceID::Switch | EventCode::Toggle;
+
+static EventLoop motorLoop;
+static TestSource motor("motor");
+static TestSource sw("switch");
+static TestSource task("task");
+static TestListener listener;
+static TestListener listener2;
+
+
+static void TestSeparateLoops()
+{
+    motorLoop.Add(motor);
+
+    CHECK(&motor.GetEventLoop() == &motorLoop);
+    CHECK(&sw.GetEventLoop() == &EventDispatcher::Default());
+
+    motor.Attach(listener);
+    CHECK(motor.Queue(TimerFiredEvent));
+
+    // The event is in the motor loop's queue
+    DrainEvents();
+    CHECK_EQUAL(0, listener.Count);
+
+    DrainEvents(motorLoop);
+    CHECK_EQUAL(1, listener.Count);
+
+    // Objects are polled by their own loop only
+    int polls = motor.PollCount;
+
+    DrainEvents();
+    CHECK_EQUAL(polls, motor.PollCount);
+
+    motorLoop.DispatchEvents();
+    CHECK_EQUAL(polls + 1, motor.PollCount);
+
+    EventDispatcher::Add(motor);
+    CHECK(&motor.GetEventLoop() == &EventDispatcher::Default());
+
+    listener.Clear();
+}
+
+
+static void TestTopics()
+{
+    IEventBinding* pTask = EventDispatcher::Subscribe(listener, EventSourceID::Task, EventMask::SourceID);
+    IEventBinding* pAborted = EventDispatcher::Subscribe(listener2, EventCode::Aborted, EventMask::EventCode);
+
+    CHECK(pTask != NULL && pAborted != NULL);
+
+    task.Dispatch(TaskStartedEvent);
+    task.Dispatch(TaskAbortedEvent);
+    sw.Dispatch(SWITCH_TOGGLE);
+    sw.Dispatch(EventSourceID::Switch | EventCode::Aborted);
+
+    CHECK_EQUAL(2, listener.Count);
+    CHECK_EQUAL(TaskStartedEvent, listener.Events[0].EventID);
+    CHECK(listener.Events[0].Source == &task);
+    CHECK_EQUAL(2, listener2.Count);
+
+    EventDispatcher::Unsubscribe(*pTask);
+    EventDispatcher::Unsubscribe(*pAborted);
+
+    task.Dispatch(TaskAbortedEvent);
+
+    CHECK_EQUAL(2, listener.Count);
+    CHECK_EQUAL(2, listener2.Count);
+
+    listener.Clear();
+    listener2.Clear();
+}
+
+
+static void TestTopicsOfOtherLoops()
+{
+    // A topic subscription only sees the events of its loop's sources
+    IEventBinding* pBinding = motorLoop.Subscribe(listener, EventSourceID::Task, EventMask::SourceID);
+
+    task.Dispatch(TaskStartedEvent);
+    CHECK_EQUAL(0, listener.Count);
+
+    motorLoop.Add(task);
+    task.Dispatch(TaskStartedEvent);
+    CHECK_EQUAL(1, listener.Count);
+
+    motorLoop.Unsubscribe(*pBinding);
+    EventDispatcher::Add(task);
+
+    listener.Clear();
+}
+
+
+static void TestTopicsAndSourceBindings()
+{
+    // Source bindings see an event before the topic subscriptions do
+    IEventBinding* pTopic = EventDispatcher::Subscribe(listener, 0, EventMask::Any);
+    IEventBinding* pSource = sw.Attach(listener);
+
+    sw.Dispatch(SWITCH_TOGGLE, 1);
+
+    CHECK_EQUAL(2, listener.Count);
+
+    sw.Detach(*pSource);
+    EventDispatcher::Unsubscribe(*pTopic);
+
+    listener.Clear();
+}
+
+
+static void TestUnsubscribeTwice()
+{
+    IEventBinding* pBinding = EventDispatcher::Subscribe(listener, EventSourceID::Task, EventMask::SourceID);
+
+    EventDispatcher::Unsubscribe(*pBinding);
+    EventDispatcher::Unsubscribe(*pBinding);
+
+    // Had the block been freed twice, the pool would hand it out twice
+    IEventBinding* p1 = EventDispatcher::Subscribe(listener, EventSourceID::Task, EventMask::SourceID);
+    IEventBinding* p2 = EventDispatcher::Subscribe(listener2, EventSourceID::Switch, EventMask::SourceID);
+
+    CHECK(p1 != NULL && p2 != NULL && p1 != p2);
+
+    // Another loop's subscription is left alone
+    motorLoop.Unsubscribe(*p2);
+
+    sw.Dispatch(SWITCH_TOGGLE);
+    CHECK_EQUAL(1, listener2.Count);
+
+    EventDispatcher::Unsubscribe(*p1);
+    EventDispatcher::Unsubscribe(*p2);
+
+    listener.Clear();
+    listener2.Clear();
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+
+    RUN_TEST(TestSeparateLoops);
+    RUN_TEST(TestTopics);
+    RUN_TEST(TestTopicsOfOtherLoops);
+    RUN_TEST(TestTopicsAndSourceBindings);
+    RUN_TEST(TestUnsubscribeTwice);
+
+    return TestHarness::Failures();
+}
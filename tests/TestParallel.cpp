@@ -0,0 +1,83 @@
+/*******************************************************************************
+Tests of parallel dispatching on worker threads.
+*******************************************************************************/
+#include <atomic>
+#include "ParallelDispatcher.h"
+#include "TestHarness.h"
+
+
+/*******************************************************************************
+A listener of a single source that checks that the source's events arrive in 
+order and one at a time.
+*******************************************************************************/
+class OrderListener : public IEventListener
+{
+    public: virtual void OnEvent(const Event* pEvent)
+    {
+        if (_isInside.exchange(true)) IsOverlapped = true;
+        if (pEvent->Data.Long != Next) IsOrdered = false;
+
+        Next = pEvent->Data.Long + 1;
+
+        _isInside = false;
+    };
+
+    public: int32_t Next = 0;
+    public: bool IsOrdered = true;
+    public: bool IsOverlapped = false;
+
+    private: std::atomic<bool> _isInside { false };
+};
+
+
+const int SOURCES = 16;
+const int EVENTS = 2000;
+
+static TestSource sources[SOURCES];
+static OrderListener listeners[SOURCES];
+
+
+static void TestParallelDispatch()
+{
+    ParallelDispatcher::Start(4);
+
+    CHECK(ParallelDispatcher::IsRunning());
+
+    int32_t next[SOURCES] = { 0 };
+
+    for (int queued = 0; queued < SOURCES * EVENTS; )
+    {
+        for (int s = 0; s < SOURCES; s++)
+        {
+            if (next[s] < EVENTS && sources[s].Queue(TimerFiredEvent, next[s])) { next[s]++; queued++; }
+        }
+
+        EventDispatcher::DispatchEvents();
+    }
+
+    DrainEvents();
+    ParallelDispatcher::WaitIdle();
+
+    CHECK_EQUAL(SOURCES * EVENTS, ParallelDispatcher::Dispatched());
+
+    ParallelDispatcher::Stop();
+
+    CHECK(!ParallelDispatcher::IsRunning());
+
+    for (int s = 0; s < SOURCES; s++)
+    {
+        CHECK_EQUAL(EVENTS, listeners[s].Next);
+        CHECK(listeners[s].IsOrdered);
+        CHECK(!listeners[s].IsOverlapped);
+    }
+}
+
+
+int main()
+{
+    for (int s = 0; s < SOURCES; s++) sources[s].Attach(listeners[s]);
+
+    RUN_TEST(TestParallelDispatch);
+
+    return TestHarness::Failures();
+}
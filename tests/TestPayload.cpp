@@ -0,0 +1,154 @@
+/*******************************************************************************
+Tests of reference-counted event payloads.
+*******************************************************************************/
+#include <string.h>
+#include "TestHarness.h"
+
+
+static TestSource source("source");
+
+
+/*******************************************************************************
+A listener that checks the payload of the events it receives, and optionally 
+keeps the last one.
+*******************************************************************************/
+class PayloadListener : public IEventListener
+{
+    public: virtual void OnEvent(const Event* pEvent)
+    {
+        EventPayload* pPayload = EventPayload::From(*pEvent);
+
+        if (pPayload != NULL && pPayload->Length == 3 && memcmp(pPayload->Data, "abc", 3) == 0) Count++;
+
+        if (IsKeeping && pPayload != NULL)
+        {
+            pPayload->AddRef();
+            pKept = pPayload;
+        }
+    };
+
+    public: int Count = 0;
+    public: bool IsKeeping = false;
+    public: EventPayload* pKept = NULL;
+};
+
+
+static PayloadListener listener;
+
+
+static EventPayload* NewPayload()
+{
+    EventPayload* pPayload = EventPayload::Allocate();
+
+    if (pPayload != NULL)
+    {
+        memcpy(pPayload->Data, "abc", 3);
+        pPayload->Length = 3;
+    }
+
+    return pPayload;
+}
+
+
+static void TestPayloadReleased()
+{
+    Event event(TimerFiredEvent, NewPayload());
+
+    CHECK(event.HasPayload);
+    CHECK_EQUAL(1, EventPayload::Count());
+    CHECK(source.Queue(event));
+
+    DrainEvents();
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(0, EventPayload::Count());
+
+    listener.Count = 0;
+}
+
+
+static void TestPayloadKept()
+{
+    Event event(TimerFiredEvent, NewPayload());
+
+    listener.IsKeeping = true;
+    source.Queue(event);
+    DrainEvents();
+
+    CHECK(listener.pKept != NULL);
+    CHECK_EQUAL(1, EventPayload::Count());
+
+    listener.pKept->Release();
+    CHECK_EQUAL(0, EventPayload::Count());
+
+    listener.IsKeeping = false;
+    listener.pKept = NULL;
+    listener.Count = 0;
+}
+
+
+static void TestPayloadPool()
+{
+    EventPayload* payloads[EVENT_PAYLOAD_POOL_SIZE];
+
+    for (int i = 0; i < EVENT_PAYLOAD_POOL_SIZE; i++) payloads[i] = NewPayload();
+
+    CHECK(EventPayload::Allocate() == NULL);
+
+    for (int i = 0; i < EVENT_PAYLOAD_POOL_SIZE; i++) payloads[i]->Release();
+
+    CHECK_EQUAL(0, EventPayload::Count());
+}
+
+
+static void TestRejectedPayload()
+{
+    // An event that can't be queued releases its payload
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) source.Queue(TimerFiredEvent);
+
+    Event event(TimerFiredEvent, NewPayload());
+
+    CHECK(!source.Queue(event));
+    CHECK_EQUAL(0, EventPayload::Count());
+
+    DrainEvents();
+}
+
+
+static void TestCoalescedPayload()
+{
+    // The payload of a coalesced event is released when it's replaced
+    source.SetCoalescing();
+
+    Event first(TimerFiredEvent, NewPayload());
+    Event second(TimerFiredEvent, NewPayload());
+
+    CHECK(source.Queue(first));
+    CHECK(source.Queue(second));
+    CHECK_EQUAL(1, EventPayload::Count());
+
+    DrainEvents();
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(0, EventPayload::Count());
+
+    source.SetCoalescing(false);
+    listener.Count = 0;
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+    source.Attach(listener);
+
+    RUN_TEST(TestPayloadReleased);
+    RUN_TEST(TestPayloadKept);
+    RUN_TEST(TestPayloadPool);
+    RUN_TEST(TestRejectedPayload);
+    RUN_TEST(TestCoalescedPayload);
+
+    return TestHarness::Failures();
+}
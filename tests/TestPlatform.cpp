@@ -0,0 +1,87 @@
+/*******************************************************************************
+Tests of the host platform layer: the simulated clock and interrupts.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static SimulatedClock simulatedClock;
+static TestSource source("source");
+static TestListener listener;
+static int isrCount = 0;
+static bool wereInterruptsDisabled = false;
+
+
+static void CountingISR()
+{
+    wereInterruptsDisabled = HostPlatform::InterruptsDisabled() && HostPlatform::InInterrupt();
+    isrCount++;
+}
+
+
+static void QueueFromISR()
+{
+    source.Queue(TimerFiredEvent, 5);
+}
+
+
+static void TestSimulatedClock()
+{
+    simulatedClock.Set(1000000);
+
+    CHECK_EQUAL(1000000, micros());
+    CHECK_EQUAL(1000, millis());
+
+    simulatedClock.Advance(2500);
+    CHECK_EQUAL(1002500, micros());
+
+    delay(10);
+    CHECK_EQUAL(1012500, micros());
+}
+
+
+static void TestRaiseInterrupt()
+{
+    // With interrupts enabled the ISR runs right away, with interrupts disabled
+    HostPlatform::RaiseInterrupt(CountingISR);
+
+    CHECK_EQUAL(1, isrCount);
+    CHECK(wereInterruptsDisabled);
+    CHECK(!HostPlatform::InterruptsDisabled());
+
+    // Otherwise it is deferred until interrupts are enabled again
+    noInterrupts();
+    HostPlatform::RaiseInterrupt(CountingISR);
+
+    CHECK_EQUAL(1, isrCount);
+    CHECK_EQUAL(1, HostPlatform::PendingInterrupts());
+
+    interrupts();
+
+    CHECK_EQUAL(2, isrCount);
+    CHECK_EQUAL(0, HostPlatform::PendingInterrupts());
+}
+
+
+static void TestEventFromISR()
+{
+    HostPlatform::RaiseInterrupt(QueueFromISR);
+    DrainEvents();
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(5, listener.Events[0].Data.Long);
+
+    listener.Clear();
+}
+
+
+int main()
+{
+    HostPlatform::SetClock(&simulatedClock);
+    source.Attach(listener);
+
+    RUN_TEST(TestSimulatedClock);
+    RUN_TEST(TestRaiseInterrupt);
+    RUN_TEST(TestEventFromISR);
+
+    return TestHarness::Failures();
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+Tests of the event queues and their overflow policies.
+*******************************************************************************/
+#include <thread>
+#include <vector>
+#include "TestHarness.h"
+
+
+template<typename QUEUE>
+static void CheckFifo(QUEUE& queue)
+{
+    Event event;
+
+    CHECK(queue.IsEmpty());
+    CHECK(!queue.Dequeue(event));
+
+    for (int i = 0; i < 4; i++) { Event in(0x0100 + i, (int32_t)i); CHECK(queue.Queue(in)); }
+
+    CHECK_EQUAL(4, queue.Count());
+
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(queue.Dequeue(event));
+        CHECK_EQUAL(0x0100 + i, event.EventID);
+        CHECK_EQUAL(i, event.Data.Long);
+    }
+
+    CHECK(queue.IsEmpty());
+}
+
+
+static void TestRejectNewest()
+{
+    EventQueue<4, QueueOverflowPolicy::RejectNewest> queue;
+    Event event(1);
+
+    CheckFifo(queue);
+
+    for (int i = 0; i < 4; i++) CHECK(queue.Queue(event));
+
+    CHECK(!queue.Queue(event));
+    CHECK_EQUAL(4, queue.Count());
+}
+
+
+static void TestOverwriteOldest()
+{
+    EventQueue<4, QueueOverflowPolicy::OverwriteOldest> queue;
+    Event event;
+
+    for (int i = 0; i < 6; i++) { Event in(1, (int32_t)i); CHECK(queue.Queue(in)); }
+
+    CHECK_EQUAL(4, queue.Count());
+    CHECK(queue.Dequeue(event));
+    CHECK_EQUAL(2, event.Data.Long);
+}
+
+
+static void TestCoalescePolicy()
+{
+    EventQueue<2, QueueOverflowPolicy::Coalesce> queue;
+    Event a(1, (int32_t)1), b(2, (int32_t)2), a2(1, (int32_t)3), c(3, (int32_t)4), event;
+
+    a.Source = b.Source = a2.Source = c.Source = NULL;
+
+    CHECK(queue.Queue(a));
+    CHECK(queue.Queue(b));
+    CHECK(queue.Queue(a2));     // Replaces the data of the pending event 1
+    CHECK(!queue.Queue(c));     // Nothing to replace
+
+    CHECK(queue.Dequeue(event));
+    CHECK_EQUAL(1, event.EventID);
+    CHECK_EQUAL(3, event.Data.Long);
+}
+
+
+static void TestLockFreeQueues()
+{
+    SpscEventQueue<4> spsc;
+    MpscEventQueue<4> mpsc;
+    Event event(1);
+
+    CheckFifo(spsc);
+    CheckFifo(mpsc);
+
+    for (int i = 0; i < 4; i++) CHECK(mpsc.Queue(event));
+
+    CHECK(!mpsc.Queue(event));
+}
+
+
+static void TestMpscProducers()
+{
+    const int PRODUCERS = 4;
+    const int EVENTS = 20000;
+
+    static MpscEventQueue<64> queue;
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([p]()
+        {
+            for (int i = 0; i < EVENTS; i++)
+            {
+                Event event((EVENT_ID)p, (int32_t)i);
+
+                while (!queue.Queue(event)) std::this_thread::yield();
+            }
+        });
+    }
+
+    // Each producer's events must arrive complete and in order
+    int next[PRODUCERS] = { 0 };
+    int received = 0;
+    bool isOrdered = true;
+    Event event;
+
+    while (received < PRODUCERS * EVENTS)
+    {
+        if (!queue.Dequeue(event)) { std::this_thread::yield(); continue; }
+
+        if (event.Data.Long != next[event.EventID]) isOrdered = false;
+
+        next[event.EventID] = event.Data.Long + 1;
+        received++;
+    }
+
+    for (auto& producer : producers) producer.join();
+
+    CHECK(isOrdered);
+    CHECK(queue.IsEmpty());
+}
+
+
+int main()
+{
+    RUN_TEST(TestRejectNewest);
+    RUN_TEST(TestOverwriteOldest);
+    RUN_TEST(TestCoalescePolicy);
+    RUN_TEST(TestLockFreeQueues);
+    RUN_TEST(TestMpscProducers);
+
+    return TestHarness::Failures();
+}
@@ -0,0 +1,136 @@
+/*******************************************************************************
+Tests of per-source queue quotas.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static TestSource chatty("chatty");
+static TestSource quiet("quiet");
+static TestListener listener;
+
+
+static void TestQuota()
+{
+    chatty.SetQueueQuota(2);
+
+    CHECK_EQUAL(2, chatty.Capacity(TimerFiredEvent));
+    CHECK(chatty.Queue(TimerFiredEvent));
+    CHECK(chatty.Queue(TimerFiredEvent));
+    CHECK(!chatty.Queue(TimerFiredEvent));
+    CHECK_EQUAL(2, chatty.PendingCount());
+    CHECK_EQUAL(0, chatty.Capacity(TimerFiredEvent));
+
+    // The other source still has the rest of the queue
+    CHECK(quiet.Queue(TimerFiredEvent));
+    CHECK_EQUAL(EVENT_QUEUE_SIZE - 3, quiet.Capacity(TimerFiredEvent));
+
+    DrainEvents();
+
+    CHECK_EQUAL(3, listener.Count);
+    CHECK_EQUAL(0, chatty.PendingCount());
+    CHECK_EQUAL(2, chatty.Capacity(TimerFiredEvent));
+
+    chatty.SetQueueQuota(0);
+    listener.Clear();
+}
+
+
+static void TestUnlimited()
+{
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) CHECK(chatty.Queue(TimerFiredEvent));
+
+    CHECK(!chatty.Queue(TimerFiredEvent));
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, chatty.PendingCount());
+
+    DrainEvents();
+
+    CHECK_EQUAL(0, chatty.PendingCount());
+
+    listener.Clear();
+}
+
+
+static void TestDequeueReturnsCredit()
+{
+    Event event;
+
+    chatty.SetQueueQuota(1);
+
+    CHECK(chatty.Queue(TimerFiredEvent));
+    CHECK(!chatty.Queue(TimerFiredEvent));
+    CHECK(EventDispatcher::Dequeue(event));
+    CHECK_EQUAL(0, chatty.PendingCount());
+    CHECK(chatty.Queue(TimerFiredEvent));
+
+    DrainEvents();
+
+    CHECK_EQUAL(0, chatty.PendingCount());
+
+    chatty.SetQueueQuota(0);
+    listener.Clear();
+}
+
+
+static void TestCoalescedEvents()
+{
+    // Coalesced events don't count against the quota
+    chatty.SetCoalescing();
+    chatty.SetQueueQuota(1);
+
+    CHECK(chatty.Queue(TimerFiredEvent, 1));
+    CHECK(chatty.Queue(TimerFiredEvent, 2));
+    CHECK_EQUAL(0, chatty.PendingCount());
+
+    DrainEvents();
+
+    CHECK_EQUAL(1, listener.Count);
+    CHECK_EQUAL(2, listener.Events[0].Data.Long);
+    CHECK_EQUAL(0, chatty.PendingCount());
+
+    chatty.SetQueueQuota(0);
+    chatty.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+static void TestCrowdedCoalescingIndex()
+{
+    // With a single coalescing slot, a second coalescing source finds the index
+    // crowded and its events are queued as they are - against its quota
+    chatty.SetCoalescing();
+    quiet.SetCoalescing();
+    quiet.SetQueueQuota(1);
+
+    CHECK(chatty.Queue(TimerFiredEvent, 1));
+    CHECK(quiet.Queue(TimerFiredEvent, 2));
+    CHECK_EQUAL(1, quiet.PendingCount());
+    CHECK(!quiet.Queue(TimerFiredEvent, 3));
+
+    DrainEvents();
+
+    CHECK_EQUAL(2, listener.Count);
+    CHECK_EQUAL(0, quiet.PendingCount());
+
+    quiet.SetQueueQuota(0);
+    quiet.SetCoalescing(false);
+    chatty.SetCoalescing(false);
+    listener.Clear();
+}
+
+
+int main()
+{
+    SimulatedClock clock;
+
+    HostPlatform::SetClock(&clock);
+    chatty.Attach(listener);
+    quiet.Attach(listener);
+
+    RUN_TEST(TestQuota);
+    RUN_TEST(TestUnlimited);
+    RUN_TEST(TestDequeueReturnsCredit);
+    RUN_TEST(TestCoalescedEvents);
+    RUN_TEST(TestCrowdedCoalescingIndex);
+
+    return TestHarness::Failures();
+}
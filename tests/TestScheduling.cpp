@@ -0,0 +1,165 @@
+/*******************************************************************************
+Tests of scheduled, ready-signal and weighted round-robin polling, and of
+sleeping while idle.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static SimulatedClock simulatedClock;
+static EventLoop loop;
+static TestSource a("a");
+static TestSource b("b");
+static TestListener listener;
+
+
+static void TestPollPeriod()
+{
+    loop.SetPollPeriod(a, 5000);
+
+    for (int i = 0; i < 20; i++)
+    {
+        simulatedClock.Advance(1000);
+        loop.DispatchEvents();
+    }
+
+    CHECK_EQUAL(4, a.PollCount);
+
+    loop.Remove(a);
+    a.PollCount = 0;
+}
+
+
+static void TestPollAfter()
+{
+    loop.PollAfter(a, 3000);
+
+    for (int i = 0; i < 10; i++)
+    {
+        simulatedClock.Advance(1000);
+        loop.DispatchEvents();
+    }
+
+    CHECK_EQUAL(1, a.PollCount);
+
+    loop.Remove(a);
+    a.PollCount = 0;
+}
+
+
+static void TestPollWhenReady()
+{
+    loop.PollWhenReady(a);
+
+    for (int i = 0; i < 10; i++) loop.DispatchEvents();
+
+    CHECK_EQUAL(0, a.PollCount);
+
+    loop.SetReady(a);
+    loop.SetReady(a);       // Marking a ready object ready again has no effect
+
+    for (int i = 0; i < 10; i++) loop.DispatchEvents();
+
+    CHECK_EQUAL(1, a.PollCount);
+
+    loop.Remove(a);
+    a.PollCount = 0;
+}
+
+
+static void TestPollWeights()
+{
+    loop.Add(a);
+    loop.Add(b);
+    a.SetPollWeight(3);
+
+    CHECK_EQUAL(3, a.GetPollWeight());
+
+    for (int i = 0; i < 8; i++) loop.DispatchEvents();
+
+    CHECK_EQUAL(6, a.PollCount);
+    CHECK_EQUAL(2, b.PollCount);
+
+    a.SetPollWeight(0);     // A weight of 0 is taken as 1
+    CHECK_EQUAL(1, a.GetPollWeight());
+
+    loop.Remove(a);
+    loop.Remove(b);
+    a.PollCount = 0;
+    b.PollCount = 0;
+}
+
+
+static void TestWaitForScheduledPoll()
+{
+    uint32_t start = micros();
+
+    loop.PollAfter(a, 10000);
+
+    // The simulated sleep advances the clock to the due time
+    CHECK(loop.WaitForEvents(100000));
+    CHECK_EQUAL(10000, micros() - start);
+
+    loop.DispatchEvents();
+    CHECK_EQUAL(1, a.PollCount);
+
+    // Nothing is left to do, so the wait times out
+    start = micros();
+    CHECK(!loop.WaitForEvents(5000));
+    CHECK_EQUAL(5000, micros() - start);
+
+    loop.Remove(a);
+    a.PollCount = 0;
+}
+
+
+static void QueueFromISR()
+{
+    a.Queue(TimerFiredEvent);
+}
+
+
+static void TestWaitForQueuedEvent()
+{
+    loop.PollWhenReady(a);
+
+    HostPlatform::RaiseInterrupt(QueueFromISR);
+
+    uint32_t start = micros();
+
+    CHECK(loop.WaitForEvents(100000));
+    CHECK_EQUAL(0, micros() - start);
+
+    loop.DispatchEvents();
+    CHECK_EQUAL(1, listener.Count);
+
+    // Round-robin objects need polling all the time, so there's no waiting
+    loop.Add(b);
+    CHECK(loop.WaitForEvents(100000));
+    CHECK_EQUAL(0, micros() - start);
+
+    loop.Remove(a);
+    loop.Remove(b);
+    listener.Clear();
+}
+
+
+int main()
+{
+    HostPlatform::SetClock(&simulatedClock);
+
+    // The objects are moved to a loop of their own, so it has nothing else to poll
+    loop.Add(a);
+    loop.Add(b);
+    loop.Remove(a);
+    loop.Remove(b);
+    a.Attach(listener);
+
+    RUN_TEST(TestPollPeriod);
+    RUN_TEST(TestPollAfter);
+    RUN_TEST(TestPollWhenReady);
+    RUN_TEST(TestPollWeights);
+    RUN_TEST(TestWaitForScheduledPoll);
+    RUN_TEST(TestWaitForQueuedEvent);
+
+    return TestHarness::Failures();
+}
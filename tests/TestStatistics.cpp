@@ -0,0 +1,91 @@
+/*******************************************************************************
+Tests of the dispatcher and per-source statistics.
+*******************************************************************************/
+#include "TestHarness.h"
+
+
+static SimulatedClock simulatedClock;
+static TestSource source("source");
+static TestListener listener;
+
+
+static void TestCounters()
+{
+    EventStatistics stats;
+
+    EventDispatcher::ResetStatistics();
+
+    for (int i = 0; i < EVENT_QUEUE_SIZE + 2; i++) source.Queue(TimerFiredEvent);
+
+    DrainEvents();
+    EventDispatcher::GetStatistics(stats);
+
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, stats.Dispatched);
+    CHECK_EQUAL(2, stats.Dropped);
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, stats.HighWater);
+    CHECK_EQUAL(EVENT_QUEUE_SIZE * EVENT_PRIORITY_LANES, stats.Capacity);
+
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, source.QueuedCount());
+    CHECK_EQUAL(2, source.DroppedCount());
+
+    EventDispatcher::ResetStatistics();
+    EventDispatcher::GetStatistics(stats);
+
+    CHECK_EQUAL(0, stats.Dispatched);
+    CHECK_EQUAL(0, stats.HighWater);
+
+    listener.Clear();
+}
+
+
+static void TestOverwriteCounters()
+{
+    EventStatistics stats;
+
+    EventDispatcher::ResetStatistics();
+
+    // Every event is queued, but the queue drops the two oldest to make room
+    for (int i = 0; i < EVENT_QUEUE_SIZE + 2; i++) CHECK(source.Queue(TimerFiredEvent, i));
+
+    DrainEvents();
+    EventDispatcher::GetStatistics(stats);
+
+    CHECK_EQUAL(EVENT_QUEUE_SIZE, stats.Dispatched);
+    CHECK_EQUAL(2, stats.Dropped);
+    CHECK_EQUAL(2, listener.Events[0].Data.Long);
+
+    listener.Clear();
+}
+
+
+static void TestLatency()
+{
+    EventStatistics stats;
+
+    EventDispatcher::ResetStatistics();
+
+    // 100us is in the bucket for 64-127us
+    source.Queue(TimerFiredEvent);
+    simulatedClock.Advance(100);
+    DrainEvents();
+
+    EventDispatcher::GetStatistics(stats);
+
+    CHECK_EQUAL(100, stats.MaxLatency);
+    CHECK_EQUAL(1, stats.Latency[3]);
+
+    listener.Clear();
+}
+
+
+int main()
+{
+    HostPlatform::SetClock(&simulatedClock);
+    source.Attach(listener);
+
+    if (EVENT_QUEUE_OVERFLOW_POLICY == QueueOverflowPolicy::OverwriteOldest) RUN_TEST(TestOverwriteCounters);
+    else RUN_TEST(TestCounters);
+    RUN_TEST(TestLatency);
+
+    return TestHarness::Failures();
+}
@@ -0,0 +1,202 @@
+/*******************************************************************************
+Tests of delayed and periodic event timers.
+*******************************************************************************/
+#include <atomic>
+#include <thread>
+#include "TestHarness.h"
+
+
+static SimulatedClock simulatedClock;
+static TestSource source("source");
+static TestListener listener;
+
+
+/// Advances the clock and dispatches the events that have come due
+static void Advance(uint32_t micros)
+{
+    simulatedClock.Advance(micros);
+    DrainEvents();
+}
+
+
+static void TestDelayedEvent()
+{
+    EVENT_TIMER timer = source.QueueAfter(TimerFiredEvent, 5000);
+
+    CHECK(timer != 0);
+    CHECK(EventLoop::IsTimerPending(timer));
+
+    Advance(4000);
+    CHECK_EQUAL(0, listener.Count);
+
+    Advance(1000);
+    CHECK_EQUAL(1, listener.Count);
+    CHECK(listener.Events[0].Source == &source);
+
+    // A timer that has fired is done; its handle is stale
+    CHECK(!EventLoop::IsTimerPending(timer));
+    CHECK(!EventLoop::CancelTimer(timer));
+
+    Advance(10000);
+    CHECK_EQUAL(1, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestPeriodicEvent()
+{
+    EVENT_TIMER timer = source.QueueEvery(TimerFiredEvent, 2000);
+
+    for (int i = 0; i < 5; i++) Advance(2000);
+
+    CHECK_EQUAL(5, listener.Count);
+    CHECK(EventLoop::IsTimerPending(timer));
+
+    // Missed firings are skipped, not made up
+    Advance(7000);
+    CHECK_EQUAL(6, listener.Count);
+
+    CHECK(EventLoop::CancelTimer(timer));
+    CHECK(!EventLoop::IsTimerPending(timer));
+
+    Advance(10000);
+    CHECK_EQUAL(6, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestCancelledTimer()
+{
+    EVENT_TIMER timer = source.QueueAfter(TimerFiredEvent, 3000);
+
+    Advance(1000);
+    CHECK(EventLoop::CancelTimer(timer));
+    CHECK(!EventLoop::CancelTimer(timer));
+
+    Advance(5000);
+    CHECK_EQUAL(0, listener.Count);
+}
+
+
+static void TestTimerPool()
+{
+    // The pool has EVENT_TIMER_POOL_SIZE (2) timers
+    EVENT_TIMER timer1 = source.QueueAfter(TimerFiredEvent, 1000);
+    EVENT_TIMER timer2 = source.QueueAfter(TimerFiredEvent, 1000);
+
+    CHECK(timer1 != 0 && timer2 != 0);
+    CHECK_EQUAL(0, source.QueueAfter(TimerFiredEvent, 1000));
+
+    CHECK(EventLoop::CancelTimer(timer1));
+
+    // A cancelled timer goes back to the pool on its loop's next DispatchEvents()
+    CHECK_EQUAL(0, source.QueueAfter(TimerFiredEvent, 1000));
+    EventDispatcher::DispatchEvents();
+
+    // The block is reused, but the old handle still refers to the cancelled timer
+    EVENT_TIMER timer3 = source.QueueAfter(TimerFiredEvent, 1000);
+
+    CHECK(timer3 != 0 && timer3 != timer1);
+    CHECK(!EventLoop::IsTimerPending(timer1));
+    CHECK(!EventLoop::CancelTimer(timer1));
+    CHECK(EventLoop::IsTimerPending(timer3));
+
+    Advance(1000);
+    CHECK_EQUAL(2, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestForgedHandles()
+{
+    // Handles that were never returned by QueueEventAfter() are rejected, whether
+    // their block is free or allocated
+    CHECK(!EventLoop::IsTimerPending(0));
+    CHECK(!EventLoop::CancelTimer(0));
+    CHECK(!EventLoop::CancelTimer(0x0001));
+    CHECK(!EventLoop::CancelTimer(0x0101));
+    CHECK(!EventLoop::CancelTimer(0xFFFF));
+
+    EVENT_TIMER timer = source.QueueAfter(TimerFiredEvent, 1000);
+
+    CHECK(!EventLoop::CancelTimer(timer & 0x00FF));
+    CHECK(!EventLoop::CancelTimer(timer + 0x0100));
+    CHECK(EventLoop::IsTimerPending(timer));
+
+    Advance(1000);
+    CHECK_EQUAL(1, listener.Count);
+
+    listener.Clear();
+}
+
+
+static void TestCancelFromOtherThread()
+{
+    // Timers of a loop running on one thread are cancelled from another
+    static EventLoop loop;
+    static TestSource remote("remote");
+    static std::atomic<EVENT_TIMER> started(0);
+    static std::atomic<bool> isStopping(false);
+
+    loop.Add(remote);
+
+    std::thread thread([]()
+    {
+        while (!isStopping)
+        {
+            if (started == 0)
+            {
+                EVENT_TIMER timer = remote.QueueAfter(TimerFiredEvent, 1000000);
+
+                if (timer != 0) started = timer;
+            }
+
+            loop.DispatchEvents();
+            std::this_thread::yield();
+        }
+
+        loop.DispatchEvents();
+    });
+
+    int cancelled = 0;
+
+    while (cancelled < 1000)
+    {
+        EVENT_TIMER timer = started.exchange(0);
+
+        if (timer == 0) { std::this_thread::yield(); continue; }
+
+        if (EventLoop::CancelTimer(timer)) cancelled++;
+    }
+
+    isStopping = true;
+    thread.join();
+
+    // Every cancelled timer has been freed
+    EVENT_TIMER timers[EVENT_TIMER_POOL_SIZE];
+
+    for (int i = 0; i < EVENT_TIMER_POOL_SIZE; i++) CHECK((timers[i] = source.QueueAfter(TimerFiredEvent, 1000)) != 0);
+    for (int i = 0; i < EVENT_TIMER_POOL_SIZE; i++) CHECK(EventLoop::CancelTimer(timers[i]));
+
+    EventDispatcher::DispatchEvents();
+    loop.Remove(remote);
+}
+
+
+int main()
+{
+    HostPlatform::SetClock(&simulatedClock);
+    source.Attach(listener);
+
+    RUN_TEST(TestDelayedEvent);
+    RUN_TEST(TestPeriodicEvent);
+    RUN_TEST(TestCancelledTimer);
+    RUN_TEST(TestTimerPool);
+    RUN_TEST(TestForgedHandles);
+    RUN_TEST(TestCancelFromOtherThread);
+
+    return TestHarness::Failures();
+}